@@ -52,6 +52,19 @@ include(zmq_find_pthreads) # make this a find_package()
 
 include(zmq_find_socket) # make this a find_package()
 
+# -----------------------------------------------------------------------------
+# find realtime library (clock_gettime), if any
+# -----------------------------------------------------------------------------
+
+set(ZMQ_RT_LIBRARIES)
+if(NOT ZMQ_HAVE_WINDOWS)
+  include(CheckLibraryExists)
+  check_library_exists(rt clock_gettime "" ZMQ_HAVE_LIBRT)
+  if(ZMQ_HAVE_LIBRT)
+    set(ZMQ_RT_LIBRARIES rt)
+  endif(ZMQ_HAVE_LIBRT)
+endif(NOT ZMQ_HAVE_WINDOWS)
+
 # -----------------------------------------------------------------------------
 # Stream Control Transmission Protocol (SCTP) functionality
 # -----------------------------------------------------------------------------
@@ -64,6 +77,22 @@ if(WITH_SCTP)
   set(ZMQ_HAVE_SCTP 1)
 endif(WITH_SCTP)
 
+# -----------------------------------------------------------------------------
+# Size of the raw message structure
+# -----------------------------------------------------------------------------
+
+if(WITH_MESSAGE_SIZE)
+  set(ZMQ_MESSAGE_SIZE ${WITH_MESSAGE_SIZE})
+endif(WITH_MESSAGE_SIZE)
+
+# -----------------------------------------------------------------------------
+# Performance counters
+# -----------------------------------------------------------------------------
+
+if(WITH_COUNTERS)
+  set(ZMQ_HAVE_COUNTERS 1)
+endif(WITH_COUNTERS)
+
 # -----------------------------------------------------------------------------
 # OpenPGM functionality
 # -----------------------------------------------------------------------------
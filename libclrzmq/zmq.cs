@@ -16,6 +16,8 @@ using System.Runtime.InteropServices;
 
         public const int STYLE_DATA_DISTRIBUTION = 1;
         public const int STYLE_LOAD_BALANCING = 2;
+        public const int STYLE_LEAST_LOADED = 3;
+        public const int STYLE_TWO_CHOICES = 4;
 
         //  Defines watermark level.
         public const int NO_LIMIT = -1;
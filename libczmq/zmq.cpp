@@ -119,6 +119,30 @@ int zmq_send (void *object_, int exchange_, const void *data_, uint64_t size_,
         block_ ? true : false);
 }
 
+int zmq_send_many (void *object_, int exchange_, const void **data_,
+    const uint64_t *sizes_, int count_, int block_)
+{
+    //  Get the context.
+    context_t *context = (context_t*) object_;
+
+    //  Create the messages.
+    assert (count_ >= 0);
+    zmq::message_t *msgs = new zmq::message_t [count_];
+    assert (msgs);
+    for (int i = 0; i != count_; i ++) {
+        msgs [i].rebuild ((size_t) sizes_ [i]);
+        memcpy (msgs [i].data (), data_ [i], (size_t) sizes_ [i]);
+    }
+
+    //  Forward the call to native 0MQ library.
+    size_t sent = context->api_thread->send_many (exchange_, msgs, count_,
+        block_ ? true : false);
+
+    //  Messages that were not sent are deallocated here.
+    delete [] msgs;
+    return (int) sent;
+}
+
 int zmq_receive (void *object_, void **data_, uint64_t *size_,
     uint32_t *type_, int block_)
 {
@@ -34,6 +34,8 @@ extern "C" {
 
 #define ZMQ_STYLE_DATA_DISTRIBUTION 1
 #define ZMQ_STYLE_LOAD_BALANCING 2
+#define ZMQ_STYLE_LEAST_LOADED 3
+#define ZMQ_STYLE_TWO_CHOICES 4
 
 #define ZMQ_NO_LIMIT -1
 #define ZMQ_NO_SWAP 0
@@ -60,6 +62,9 @@ void ZMQ_EXPORT zmq_bind (void *object_, const char *exchange_name_,
 int ZMQ_EXPORT zmq_send (void *object_, int exchange_, const void *data_,
     uint64_t size_, int block_);
 
+int ZMQ_EXPORT zmq_send_many (void *object_, int exchange_,
+    const void **data_, const uint64_t *sizes_, int count_, int block_);
+
 int ZMQ_EXPORT zmq_receive (void *object_, void **data_, uint64_t *size_,
     uint32_t *type_, int block_);
 
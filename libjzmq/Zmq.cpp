@@ -248,6 +248,33 @@ JNIEXPORT jboolean JNICALL Java_org_zmq_Zmq_send (JNIEnv *env, jobject obj,
     return (jboolean) context->api_thread->send (exchange, msg, (bool) block);
 }
 
+JNIEXPORT jint JNICALL Java_org_zmq_Zmq_sendMany (JNIEnv *env, jobject obj,
+    jint exchange, jobjectArray messages, jboolean block)
+{
+    //  Get the context.
+    context_t *context = (context_t*) env->GetLongField (obj, context_fid);
+    assert (context);
+
+    //  Create the messages from the bytearrays.
+    jsize count = env->GetArrayLength (messages);
+    zmq::message_t *msgs = new zmq::message_t [count];
+    assert (msgs);
+    for (jsize i = 0; i != count; i ++) {
+        jbyteArray message =
+            (jbyteArray) env->GetObjectArrayElement (messages, i);
+        jsize size = env->GetArrayLength (message); 
+        msgs [i].rebuild (size);
+        env->GetByteArrayRegion (message, 0, size, (jbyte*) msgs [i].data ());
+        env->DeleteLocalRef (message);
+    }
+
+    //  Send the messages.
+    size_t sent = context->api_thread->send_many (exchange, msgs, count,
+        (bool) block);
+    delete [] msgs;
+    return (jint) sent;
+}
+
 JNIEXPORT jobject JNICALL Java_org_zmq_Zmq_receive (JNIEnv *env, jobject obj,
     jboolean block)
 {
@@ -46,6 +46,14 @@ public class Zmq
     /**  Specifies load balancing style. */
     public static final int STYLE_LOAD_BALANCING = 2;
 
+    /**  Specifies load balancing style sending messages to the least
+     *   loaded queue. */
+    public static final int STYLE_LEAST_LOADED = 3;
+
+    /**  Specifies load balancing style sending messages to the less loaded
+     *   of two randomly chosen queues. */
+    public static final int STYLE_TWO_CHOICES = 4;
+
     /**  Specifies that there's no high watermark for the queue. It can consume
      *   as much memory as needed. 
      */
@@ -120,6 +128,18 @@ public class Zmq
      */    
     public native boolean send (int exchange, byte [] message, boolean block);
 
+    /**
+     * Send several binary messages to the specified exchange in one go.
+     * 
+     * @param exchange identifies the exchange to be sent the binary data.
+     * @param messages binary messages to be sent to the exchange.
+     * @param block if it is set to true, execution will be blocked until
+     * 	  all the messages are enqueued.
+     * @return number of messages successfully enqueued.
+     */    
+    public native int sendMany (int exchange, byte [][] messages,
+        boolean block);
+
     /**  
      *   Ad-hoc structure used to return multiple values from the
      *   'receive' method.
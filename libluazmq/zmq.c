@@ -689,6 +689,8 @@ int luaopen_libluazmq (lua_State *L)
     SETVAR("MESSAGE_GAP", ZMQ_MESSAGE_GAP)
     SETVAR("STYLE_DATA_DISTRIBUTION", ZMQ_STYLE_DATA_DISTRIBUTION)
     SETVAR("STYLE_LOAD_BALANCING", ZMQ_STYLE_LOAD_BALANCING)
+    SETVAR("STYLE_LEAST_LOADED", ZMQ_STYLE_LEAST_LOADED)
+    SETVAR("STYLE_TWO_CHOICES", ZMQ_STYLE_TWO_CHOICES)
     SETVAR("NO_LIMIT", ZMQ_NO_LIMIT)
     SETVAR("NO_SWAP", ZMQ_NO_SWAP)
     SETVAR("TRUE", ZMQ_TRUE)
@@ -178,6 +178,49 @@ PyObject *pyZMQ_send (pyZMQ *self, PyObject *args, PyObject *kwdict)
     return PyInt_FromLong (sent ? 1 : 0);
 }
 
+PyObject *pyZMQ_send_many (pyZMQ *self, PyObject *args, PyObject *kwdict)
+{
+    PyObject *py_messages = NULL;
+    int exchange = 0;
+    bool block = true;
+
+    static const char *kwlist [] = {"exchange", "py_messages", "block", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwdict, "iOb", (char**) kwlist,
+          &exchange, &py_messages, &block))
+        return NULL;
+
+    PyObject *seq = PySequence_Fast (py_messages,
+        "messages must be a sequence of strings");
+    if (!seq)
+        return NULL;
+
+    //  Copy the strings into the messages.
+    Py_ssize_t count = PySequence_Fast_GET_SIZE (seq);
+    zmq::message_t *messages = new zmq::message_t [count];
+    assert (messages);
+    for (Py_ssize_t i = 0; i != count; i ++) {
+        PyObject *py_message = PySequence_Fast_GET_ITEM (seq, i);
+        if (!PyString_Check (py_message)) {
+            delete [] messages;
+            Py_DECREF (seq);
+            PyErr_SetString (PyExc_TypeError,
+                "messages must be a sequence of strings");
+            return NULL;
+        }
+        messages [i].rebuild (PyString_Size (py_message));
+        memcpy (messages [i].data (), PyString_AsString (py_message),
+            messages [i].size ());
+    }
+    Py_DECREF (seq);
+
+    size_t sent = self->api_thread->send_many (exchange, messages, count,
+        block);
+    delete [] messages;
+
+    return PyInt_FromLong ((long) sent);
+}
+
 PyObject *pyZMQ_receive (pyZMQ *self, PyObject *args, PyObject *kwdict)
 {
     zmq::message_t message;
@@ -249,6 +292,17 @@ static PyMethodDef pyZMQ_methods [] =
         "'message' is message to be sent.\n"
         "'block' is either true or false.\n"
     },
+    {
+        "send_many",
+        (PyCFunction) pyZMQ_send_many,
+        METH_VARARGS | METH_KEYWORDS, 
+        "send_many (exchange, messages, block) -> sent\n\n"
+        "Send several messages to the specified exchange in one go, "
+        "returns number of messages sent.\n"
+        "'exchange' is the id of exchange.\n"
+        "'messages' is a sequence of messages to be sent.\n"
+        "'block' is either true or false.\n"
+    },
     {
         "receive",
         (PyCFunction) pyZMQ_receive,
@@ -268,6 +322,7 @@ static const char* pyZMQ_ZMQ_doc =
     "  create_queue\n"
     "  bind\n"
     "  send\n"
+    "  send_many\n"
     "  receive\n\n";
 
 static PyTypeObject pyZMQType =
@@ -335,6 +390,7 @@ static const char* pyZMQ_doc =
     "  create_queuee\n"
     "  bind\n"
     "  send\n"
+    "  send_many\n"
     "  receive\n"
     "\n"
     "For more information see http://www.zeromq.org.\n"
@@ -381,6 +437,14 @@ PyMODINIT_FUNC initlibpyzmq (void)
     PyDict_SetItemString (d, "STYLE_LOAD_BALANCING", t);
     Py_DECREF (t);
 
+    t = PyInt_FromLong (zmq::style_least_loaded);
+    PyDict_SetItemString (d, "STYLE_LEAST_LOADED", t);
+    Py_DECREF (t);
+
+    t = PyInt_FromLong (zmq::style_two_choices);
+    PyDict_SetItemString (d, "STYLE_TWO_CHOICES", t);
+    Py_DECREF (t);
+
     t = PyInt_FromLong (zmq::no_limit);
     PyDict_SetItemString (d, "NO_LIMIT", t);
     Py_DECREF (t);
@@ -193,6 +193,10 @@ void Init_librbzmq() {
         INT2NUM (zmq::style_data_distribution));
     rb_define_global_const ("ZMQ_STYLE_LOAD_BALANCING", 
         INT2NUM (zmq::style_load_balancing));
+    rb_define_global_const ("ZMQ_STYLE_LEAST_LOADED", 
+        INT2NUM (zmq::style_least_loaded));
+    rb_define_global_const ("ZMQ_STYLE_TWO_CHOICES", 
+        INT2NUM (zmq::style_two_choices));
     rb_define_global_const ("ZMQ_NO_LIMIT", INT2NUM (zmq::no_limit));
     rb_define_global_const ("ZMQ_NO_SWAP", INT2NUM (zmq::no_swap));
     rb_define_global_const ("ZMQ_TRUE", INT2NUM (1));
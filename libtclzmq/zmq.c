@@ -1069,6 +1069,8 @@ int Tclzmq_Init (Tcl_Interp *interp)
     Zmqtcl_SetVar (interp, "ZMQ::MESSAGE_GAP"            , ZMQ_MESSAGE_GAP            );
     Zmqtcl_SetVar (interp, "ZMQ::STYLE_DATA_DISTRIBUTION", ZMQ_STYLE_DATA_DISTRIBUTION);
     Zmqtcl_SetVar (interp, "ZMQ::STYLE_LOAD_BALANCING"   , ZMQ_STYLE_LOAD_BALANCING   );
+    Zmqtcl_SetVar (interp, "ZMQ::STYLE_LEAST_LOADED"     , ZMQ_STYLE_LEAST_LOADED     );
+    Zmqtcl_SetVar (interp, "ZMQ::STYLE_TWO_CHOICES"      , ZMQ_STYLE_TWO_CHOICES      );
     Zmqtcl_SetVar (interp, "ZMQ::NO_LIMIT"               , ZMQ_NO_LIMIT               );
     Zmqtcl_SetVar (interp, "ZMQ::NO_SWAP"                , ZMQ_NO_SWAP                );
     Zmqtcl_SetVar (interp, "ZMQ::TRUE"                   , ZMQ_TRUE                   );
@@ -40,7 +40,9 @@ zmq::amqp_client_t::amqp_client_t (i_thread *calling_thread_,
     socket (hostname_),
     poller (NULL),
     local_object (local_object_),
-    arguments (arguments_)
+    arguments (arguments_),
+    in_batch (true, bp_in_batch_size, bp_min_batch_size, bp_max_batch_size),
+    out_batch (false, bp_out_batch_size, bp_min_batch_size, bp_max_batch_size)
 {
     //  Allocate read and write buffers.
     writebuf = (unsigned char*) malloc (writebuf_size);
@@ -166,6 +168,13 @@ void zmq::amqp_client_t::in_event ()
     //  If there's no data to process in the buffer, read new data.
     if (read_pos == read_size) {
 
+        //  Resize the buffer if the batch size have changed.
+        if (readbuf_size != (int) in_batch.size ()) {
+            readbuf_size = in_batch.size ();
+            readbuf = (unsigned char*) realloc (readbuf, readbuf_size);
+            errno_assert (readbuf);
+        }
+
         //  Read as much data as possible to the read buffer.
         read_size = socket.read (readbuf, readbuf_size);
         read_pos = 0;
@@ -175,6 +184,9 @@ void zmq::amqp_client_t::in_event ()
             error ();
             return;
         }
+
+        //  Adjust the batch size to the amount of data available.
+        in_batch.update (read_size);
     }
 
     //  If there's at least one unprocessed byte in the buffer, process it.
@@ -230,10 +242,21 @@ void zmq::amqp_client_t::out_event ()
     //  If write buffer is empty, try to read new data from the encoder.
     if (write_pos == write_size) {
 
+        //  Resize the buffer if the batch size have changed.
+        if (writebuf_size != (int) out_batch.size ()) {
+            writebuf_size = out_batch.size ();
+            writebuf = (unsigned char*) realloc (writebuf, writebuf_size);
+            errno_assert (writebuf);
+        }
+
         write_size = encoder->zmq::encoder_t<amqp_encoder_t>::read (
             writebuf, writebuf_size);
         write_pos = 0;
 
+        //  Adjust the batch size to the amount of data available.
+        if (write_size)
+            out_batch.update (write_size);
+
         //  If there is no data to send, stop polling for output.
         if (write_size == 0)
             poller->reset_pollout (handle);
@@ -272,6 +295,12 @@ void zmq::amqp_client_t::unregister_event ()
     }
 }
 
+bool zmq::amqp_client_t::detach_event ()
+{
+    //  Moving the engine to a different I/O thread is not supported.
+    return false;
+}
+
 void zmq::amqp_client_t::connection_start (
     uint16_t channel_,
     uint8_t version_major_,
@@ -458,7 +487,7 @@ void zmq::amqp_client_t::reconnect ()
     //  failed. We are going to wait a while before trying to reconnect anew
     //  to prevent reconnect consuming 100% of the processor time.
     if (state == state_connecting) {
-        poller->add_timer (this);
+        poller->add_timer (this, reconnect_period);
         state = state_waiting_for_reconnect;
         return;
     }
@@ -468,7 +497,7 @@ void zmq::amqp_client_t::reconnect ()
     //  it anew.
     socket.reopen (); 
     if (socket.get_fd () == retired_fd) {
-        poller->add_timer (this);
+        poller->add_timer (this, reconnect_period);
         state = state_waiting_for_reconnect;
         return;
     }
@@ -19,15 +19,50 @@
 
 #include <zmq/api_thread.hpp>
 #include <zmq/config.hpp>
+#include <zmq/thread.hpp>
+#include <zmq/engine_options.hpp>
+
+#include <string.h>
+
+#if defined ZMQ_HAVE_WINDOWS
+#include <zmq/windows.hpp>
+#else
+#include <sched.h>
+#endif
 
 #if defined(_MSC_VER) && defined(ZMQ_HAVE_RDTSC_IN_API_THREAD)
 #include <intrin.h>
 #pragma intrinsic(__rdtsc)
 #endif
 
+#if defined ZMQ_HAVE_RDTSC_IN_API_THREAD
+
+//  Returns current value of the timestamp counter.
+static inline uint64_t get_ticks ()
+{
+#if defined __GNUC__
+    uint32_t low;
+    uint32_t high;
+    __asm__ volatile ("rdtsc"
+        : "=a" (low), "=d" (high));
+    return (uint64_t) high << 32 | low;
+#elif defined _MSC_VER
+    return __rdtsc ();
+#else
+#error
+#endif
+}
+
+#endif
+
 zmq::api_thread_t *zmq::api_thread_t::create (dispatcher_t *dispatcher_,
-    i_locator *locator_)
+    i_locator *locator_, uint64_t affinity_)
 {
+    //  Pin the application thread first so that the memory allocated below
+    //  (and the pipe chunks the thread is going to read from) is local
+    //  to the CPUs it runs on.
+    thread_t::set_affinity (affinity_);
+
     return new api_thread_t (dispatcher_, locator_);
 }
 
@@ -37,19 +72,41 @@ zmq::api_thread_t::api_thread_t (dispatcher_t *dispatcher_,
     ticks (0),
     dispatcher (dispatcher_),
     locator (locator_),
+    message_cache (NULL),
+    ready_queues (0),
     current_queue (0),
-    message_mask (message_data)
+    message_mask (message_data),
+    spin_cycles (0),
+    yield_count (0)
 {
 #if defined ZMQ_HAVE_RDTSC_IN_API_THREAD
     last_command_time = 0;
 #endif
+    memset (&receive_stats, 0, sizeof (receive_stats));
 
     //  Register the thread with the command dispatcher.
     thread_id = dispatcher->allocate_thread_id (this, &pollset);
+
+    //  API thread runs in the context of the application thread. Let
+    //  the application thread use the message pool, if there's one.
+    if (dispatcher->get_message_pool ())
+        message_cache = dispatcher->get_message_pool ()->attach ();
 }
 
 zmq::api_thread_t::~api_thread_t ()
 {
+    for (shared_exchanges_t::iterator it = shared_exchanges.begin ();
+          it != shared_exchanges.end (); it ++)
+        delete *it;
+
+    for (bindings_t::iterator it = bindings.begin (); it != bindings.end ();
+          it ++)
+        delete *it;
+
+    //  Hand the message cache over to the next thread attaching to the pool.
+    //  Make sure this thread doesn't use it any more.
+    if (message_cache)
+        dispatcher->get_message_pool ()->detach (message_cache);
 }
 
 void zmq::api_thread_t::mask (uint32_t notifications_)
@@ -71,8 +128,7 @@ int zmq::api_thread_t::create_exchange (const char *name_,
           it != exchanges.end (); it ++)
         assert (it->first != name_);
 
-    out_engine_t *engine = out_engine_t::create (
-        style_ == style_load_balancing);
+    out_engine_t *engine = out_engine_t::create (style_);
     exchanges.push_back (exchanges_t::value_type (name_, engine));
 
     //  If the scope of the exchange is local, we won't register it
@@ -91,7 +147,7 @@ int zmq::api_thread_t::create_exchange (const char *name_,
 int zmq::api_thread_t::create_queue (const char *name_, scope_t scope_,
     const char *location_, i_thread *listener_thread_,
     int handler_thread_count_, i_thread **handler_threads_,
-    int64_t hwm_, int64_t lwm_, uint64_t swap_)
+    int64_t hwm_, int64_t lwm_, uint64_t swap_, size_t conflate_)
 {
     assert (scope_ == scope_local || scope_ == scope_process ||
         scope_ == scope_global);
@@ -102,9 +158,15 @@ int zmq::api_thread_t::create_queue (const char *name_, scope_t scope_,
           it != queues.end (); it ++)
         assert (it->first != name_);
 
-    in_engine_t *engine = in_engine_t::create (hwm_, lwm_, swap_);
+    in_engine_t *engine = in_engine_t::create (hwm_, lwm_, swap_,
+        conflate_);
     queues.push_back (queues_t::value_type (name_, engine));
 
+    //  The queue has no pipes yet, so it's idle.
+    engine->set_index (queues.size () - 1);
+    queue_link_t link = {false, 0, 0};
+    queue_links.push_back (link);
+
     //  If the scope of the queue is local, we won't register it
     //  with the locator.
     if (scope_ == scope_local)
@@ -160,6 +222,45 @@ void zmq::api_thread_t::bind (const char *exchange_name_,
         queue_thread, queue_engine);
     assert (pipe);
 
+    //  If the binding is restricted to particular topics, the exchange
+    //  passes only the matching messages to the pipe.
+    pipe_t::topics_t topics;
+    engine_options_t exchange_options (exchange_options_);
+    exchange_options.get_all ("subscribe", topics);
+    engine_options_t queue_options (queue_options_);
+    queue_options.get_all ("subscribe", topics);
+    if (!topics.empty ())
+        pipe->set_topics (topics);
+
+    //  Set how the queue should schedule the pipe relative to other pipes.
+    int priority = (int) queue_options.get ("priority", 0);
+    int64_t weight = queue_options.get ("weight", 0);
+    assert (weight >= 0);
+    pipe->set_scheduling (priority, weight);
+
+    //  Find out what the exchange should do when the pipe is full.
+    //  Queue options take precedence over exchange options.
+    std::vector <std::string> overflow;
+    exchange_options.get_all ("overflow", overflow);
+    queue_options.get_all ("overflow", overflow);
+    if (!overflow.empty ()) {
+        const std::string &policy = overflow.back ();
+        uint64_t timeout = queue_options.get ("overflow_timeout",
+            exchange_options.get ("overflow_timeout", 0));
+        if (policy == "drop")
+            pipe->set_overflow (pipe_t::overflow_drop, timeout);
+        else if (policy == "conflate")
+            pipe->set_overflow (pipe_t::overflow_conflate, timeout);
+        else if (policy == "disconnect")
+            pipe->set_overflow (pipe_t::overflow_disconnect, timeout);
+        else
+            assert (policy == "block");
+    }
+
+    //  Let the exchange know which queue the pipe leads to (see
+    //  get_dropped).
+    pipe->set_queue_name (queue_name_);
+
     //  Bind the source end of the pipe.
     command_t cmd_send_to;
     cmd_send_to.init_engine_send_to (exchange_engine, pipe);
@@ -188,7 +289,9 @@ bool zmq::api_thread_t::send (int exchange_, message_t &message_, bool block_)
         //  Oops, we couldn't send the message. Wait for the next
         //  command, process it and try to send the message again.
         while (!sent) {
-            process_commands (pollset.poll ());
+            signals_t signals;
+            pollset.poll (signals);
+            process_commands (signals);
             sent = exchanges [exchange_].second->write (message_);
         }
     }
@@ -218,7 +321,9 @@ bool zmq::api_thread_t::presend (int exchange_, message_t &message_,
         //  and try to send the message again. If there is no command
         //  available, wait for one.
         while (!sent) {
-            process_commands (pollset.poll ());
+            signals_t signals;
+            pollset.poll (signals);
+            process_commands (signals);
             sent = exchanges [exchange_].second->write (message_);
         }
     }
@@ -226,6 +331,40 @@ bool zmq::api_thread_t::presend (int exchange_, message_t &message_,
     return sent;
 }
 
+size_t zmq::api_thread_t::send_many (int exchange_, message_t *msgs_,
+    size_t count_, bool block_)
+{
+    //  Only data messages can be sent (see 'send' for details).
+    for (size_t i = 0; i != count_; i ++)
+        assert (msgs_ [i].type () == message_data);
+
+    //  Process pending commands, if any.
+    process_commands ();
+
+    //  Try to send the messages.
+    out_engine_t *exchange = exchanges [exchange_].second;
+    size_t sent = exchange->write_many (msgs_, count_);
+
+    if (block_) {
+
+        //  We couldn't send all the messages. Flush the ones already sent so
+        //  that the reader can make room for the rest, wait for the next
+        //  command, process it and try to send the rest again.
+        while (sent != count_) {
+            exchange->flush ();
+            signals_t signals;
+            pollset.poll (signals);
+            process_commands (signals);
+            sent += exchange->write_many (msgs_ + sent, count_ - sent);
+        }
+    }
+
+    //  Flush the messages to the pipes.
+    exchange->flush ();
+
+    return sent;
+}
+
 void zmq::api_thread_t::flush ()
 {
     //  Process pending commands, if any.
@@ -237,42 +376,112 @@ void zmq::api_thread_t::flush ()
         it->second->flush ();
 }
 
+zmq::shared_exchange_t *zmq::api_thread_t::share_exchange (int exchange_)
+{
+    out_engine_t *engine = exchanges [exchange_].second;
+    for (shared_exchanges_t::iterator it = shared_exchanges.begin ();
+          it != shared_exchanges.end (); it ++)
+        if ((*it)->engine == engine)
+            return *it;
+
+    //  Other threads wake this thread up by sending a signal from its own
+    //  thread ID. The thread never sends commands to itself, so there are
+    //  no commands to be read when the signal arrives.
+    shared_exchange_t *shared = new shared_exchange_t (engine, &pollset,
+        thread_id);
+    assert (shared);
+    shared_exchanges.push_back (shared);
+    return shared;
+}
+
 int zmq::api_thread_t::fetch_message (message_t *message_)
 {
-    for (queues_t::size_type i = 0; i < queues.size (); i ++) {
+    //  Round-robin over the ready queues.
+    while (ready_queues) {
+
+        queues_t::size_type qid = current_queue;
+        in_engine_t *queue = queues [qid].second;
+        bool retrieved = queue->read (message_);
+        while (retrieved) {
+            if ((message_->type () & message_mask) != 0) {
+                current_queue = queue_links [qid].next;
+                return qid + 1;
+            }
+            retrieved = queue->read (message_);
+        }
+
+        //  The queue is empty. Don't visit it till it gets ready anew.
+        deactivate_queue (qid);
+    }
+
+    return 0;
+}
 
-        //  Move to the next queue.
-        current_queue ++;
-        if (current_queue == queues.size ())
-           current_queue = 0;
+size_t zmq::api_thread_t::fetch_messages (message_t *messages_,
+    size_t count_, int *qid_)
+{
+    //  Round-robin over the ready queues.
+    while (ready_queues) {
 
-        bool retrieved = queues [current_queue].second->read (message_);
+        queues_t::size_type qid = current_queue;
+        in_engine_t *queue = queues [qid].second;
+        size_t retrieved = queue->read_batch (messages_, count_);
         while (retrieved) {
-            if ((message_->type () & message_mask) != 0)
-                return current_queue + 1;
-            retrieved = queues [current_queue].second->read (message_);
+
+            //  Drop the messages of types user is not interested in.
+            size_t kept = 0;
+            for (size_t j = 0; j != retrieved; j ++) {
+                if ((messages_ [j].type () & message_mask) == 0)
+                    continue;
+                if (kept != j)
+                    messages_ [j].move_to (&messages_ [kept]);
+                kept ++;
+            }
+            for (size_t j = kept; j != retrieved; j ++)
+                messages_ [j].rebuild (0);
+
+            if (kept) {
+                current_queue = queue_links [qid].next;
+                *qid_ = qid + 1;
+                return kept;
+            }
+            retrieved = queue->read_batch (messages_, count_);
         }
+
+        //  The queue is empty. Don't visit it till it gets ready anew.
+        deactivate_queue (qid);
     }
 
+    *qid_ = 0;
     return 0;
 }
 
 int zmq::api_thread_t::blocking_receive (message_t *message_)
 {
     int qid = fetch_message (message_);
+    if (qid) {
+        record_receive (receive_immediate, 0);
+        return qid;
+    }
+
+#if defined ZMQ_HAVE_RDTSC_IN_API_THREAD
+    uint64_t start = get_ticks ();
+#else
+    uint64_t start = 0;
+#endif
 
+    receive_stage_t stage;
     while (!qid) {
         //  This is a blocking call and we have no messages.
         //  We wait for commands, process them and continue
         //  with getting the messages.
-        ypollset_t::integer_t signals = pollset.poll ();
-        assert (signals);
-        process_commands (signals);
+        stage = wait_for_commands (start);
         ticks = 0;
 
         qid = fetch_message (message_);
     }
 
+    record_receive (stage, start);
     return qid;
 }
 
@@ -281,8 +490,8 @@ int zmq::api_thread_t::non_blocking_receive (message_t *message_)
     int qid = fetch_message (message_);
 
     if (!qid) {
-        ypollset_t::integer_t signals = pollset.check ();
-        if (signals) {
+        signals_t signals;
+        if (pollset.check (signals)) {
             process_commands (signals);
             qid = fetch_message (message_);
         }
@@ -305,8 +514,8 @@ int zmq::api_thread_t::receive (message_t *message_, bool block_)
     //  because there are messages available all the time. If poll occurs,
     //  ticks is set to zero and thus we avoid this code.
     if (++ ticks == api_thread_poll_rate) {
-        ypollset_t::integer_t signals = pollset.check ();
-        if (signals)
+        signals_t signals;
+        if (pollset.check (signals))
             process_commands (signals);
         ticks = 0;
     }
@@ -314,6 +523,160 @@ int zmq::api_thread_t::receive (message_t *message_, bool block_)
     return qid;
 }
 
+size_t zmq::api_thread_t::receive_many (message_t *messages_, size_t count_,
+    int *qid_, bool block_)
+{
+    assert (count_ > 0);
+
+    int qid;
+    size_t retrieved = fetch_messages (messages_, count_, &qid);
+
+    if (retrieved && block_)
+        record_receive (receive_immediate, 0);
+
+    if (!retrieved) {
+        if (block_) {
+
+            //  Wait for commands, process them and try to get the messages
+            //  anew. Same as in blocking_receive.
+#if defined ZMQ_HAVE_RDTSC_IN_API_THREAD
+            uint64_t start = get_ticks ();
+#else
+            uint64_t start = 0;
+#endif
+            receive_stage_t stage;
+            while (!retrieved) {
+                stage = wait_for_commands (start);
+                ticks = 0;
+                retrieved = fetch_messages (messages_, count_, &qid);
+            }
+            record_receive (stage, start);
+        }
+        else {
+            signals_t signals;
+            if (pollset.check (signals)) {
+                process_commands (signals);
+                retrieved = fetch_messages (messages_, count_, &qid);
+            }
+        }
+    }
+
+    //  Check for signals once every api_thread_poll_rate messages
+    //  (see 'receive' for details).
+    ticks += retrieved;
+    if (ticks >= api_thread_poll_rate) {
+        signals_t signals;
+        if (pollset.check (signals))
+            process_commands (signals);
+        ticks = 0;
+    }
+
+    if (qid_)
+        *qid_ = qid;
+    return retrieved;
+}
+
+void zmq::api_thread_t::receive_policy (uint64_t spin_cycles_,
+    int yield_count_)
+{
+    assert (yield_count_ >= 0);
+    spin_cycles = spin_cycles_;
+    yield_count = yield_count_;
+}
+
+void zmq::api_thread_t::get_receive_stats (receive_stats_t *stats_)
+{
+    *stats_ = receive_stats;
+}
+
+void zmq::api_thread_t::count_drops (out_engine_t *exchange_, pipe_t *pipe_)
+{
+    if (pipe_->get_overflow () == pipe_t::overflow_block)
+        return;
+
+    exchanges_t::iterator it;
+    for (it = exchanges.begin (); it != exchanges.end (); it ++)
+        if (it->second == exchange_)
+            break;
+    assert (it != exchanges.end ());
+
+    //  The pipe is written to by this thread only, thus the counter
+    //  needs no synchronisation.
+    binding_t *binding = new binding_t;
+    assert (binding);
+    binding->exchange_name = it->first;
+    binding->queue_name = pipe_->get_queue_name ();
+    binding->dropped = 0;
+    bindings.push_back (binding);
+    pipe_->set_drop_counter (&binding->dropped);
+}
+
+uint64_t zmq::api_thread_t::get_dropped (const char *exchange_name_,
+    const char *queue_name_)
+{
+    //  The exchange may be bound to the same queue several times.
+    uint64_t dropped = 0;
+    for (bindings_t::iterator it = bindings.begin (); it != bindings.end ();
+          it ++)
+        if ((*it)->exchange_name == exchange_name_ &&
+              (*it)->queue_name == queue_name_)
+            dropped += (*it)->dropped;
+    return dropped;
+}
+
+zmq::receive_stage_t zmq::api_thread_t::wait_for_commands (uint64_t start_)
+{
+    signals_t signals;
+    receive_stage_t stage = receive_park;
+
+#if defined ZMQ_HAVE_RDTSC_IN_API_THREAD
+
+    //  Busy-wait till the spinning period since the start of the receive
+    //  elapses.
+    while (get_ticks () - start_ < spin_cycles) {
+        if (pollset.check (signals)) {
+            stage = receive_spin;
+            break;
+        }
+        cpu_relax ();
+    }
+#endif
+
+    //  Yield the CPU to other threads for a while.
+    for (int i = 0; stage == receive_park && i != yield_count; i ++) {
+#if defined ZMQ_HAVE_WINDOWS
+        SwitchToThread ();
+#else
+        sched_yield ();
+#endif
+        if (pollset.check (signals))
+            stage = receive_yield;
+    }
+
+    //  Go asleep.
+    if (stage == receive_park)
+        pollset.poll (signals);
+
+    process_commands (signals);
+    return stage;
+}
+
+void zmq::api_thread_t::record_receive (receive_stage_t stage_,
+    uint64_t start_)
+{
+    receive_stats.stages [stage_] ++;
+
+#if defined ZMQ_HAVE_RDTSC_IN_API_THREAD
+    if (stage_ == receive_immediate)
+        return;
+    uint64_t cycles = get_ticks () - start_;
+    int bucket = 0;
+    while (cycles >>= 1)
+        bucket ++;
+    receive_stats.wait_cycles [bucket] ++;
+#endif
+}
+
 zmq::dispatcher_t *zmq::api_thread_t::get_dispatcher ()
 {
     return dispatcher;
@@ -359,15 +722,23 @@ void zmq::api_thread_t::process_command (const command_t &command_)
             switch (engcmd.type) {
             case engine_command_t::revive:
                 engine->revive (engcmd.args.revive.pipe);
+
+                //  Only queues receive messages in API thread.
+                activate_queue ((in_engine_t*) engine);
                 break;
             case engine_command_t::head:
                 engine->head (engcmd.args.head.pipe, engcmd.args.head.position);
                 break;
             case engine_command_t::send_to:
+
+                //  Only exchanges send messages in API thread.
+                count_drops ((out_engine_t*) engine,
+                    engcmd.args.send_to.pipe);
                 engine->send_to (engcmd.args.send_to.pipe);
                 break;
             case engine_command_t::receive_from:
                 engine->receive_from (engcmd.args.receive_from.pipe);
+                activate_queue ((in_engine_t*) engine);
                 break;
             case engine_command_t::terminate_pipe:
                 engine->terminate_pipe (engcmd.args.terminate_pipe.pipe);
@@ -384,23 +755,74 @@ void zmq::api_thread_t::process_command (const command_t &command_)
             break;
         }
 
+    //  Engine on the other end of the pipe has moved to a different thread.
+    //  Confirm the change to its old thread (see command_t).
+    case command_t::rehome_pipe:
+        {
+            i_engine *engine = command_.args.rehome_pipe.engine;
+            i_thread *old_thread = command_.args.rehome_pipe.pipe->rehome (
+                engine, command_.args.rehome_pipe.thread);
+            command_t cmd;
+            cmd.init_rehome_pipe_ack (engine);
+            send_command (old_thread, cmd);
+            break;
+        }
+
     //  Unsupported/unknown command.
     default:
         assert (false);
     }
 }
 
-void zmq::api_thread_t::process_commands (ypollset_t::integer_t signals_)
+void zmq::api_thread_t::activate_queue (in_engine_t *queue_)
 {
-    for (int source_thread_id = 0;
-          source_thread_id != dispatcher->get_thread_count ();
-          source_thread_id ++) {
-        if (signals_ & (ypollset_t::integer_t (1) << source_thread_id)) {
-            command_t command;
-            while (dispatcher->read (source_thread_id, thread_id, &command))
-                process_command (command);
-        }
+    queues_t::size_type qid = queue_->get_index ();
+    queue_link_t &link = queue_links [qid];
+    if (link.ready || !queue_->ready ())
+        return;
+
+    //  Link the queue just before the current one.
+    link.ready = true;
+    if (!ready_queues) {
+        link.prev = qid;
+        link.next = qid;
+        current_queue = qid;
     }
+    else {
+        link.next = current_queue;
+        link.prev = queue_links [current_queue].prev;
+        queue_links [link.prev].next = qid;
+        queue_links [link.next].prev = qid;
+    }
+    ready_queues ++;
+}
+
+void zmq::api_thread_t::deactivate_queue (size_t qid_)
+{
+    queue_link_t &link = queue_links [qid_];
+    assert (link.ready);
+    link.ready = false;
+    ready_queues --;
+    queue_links [link.prev].next = link.next;
+    queue_links [link.next].prev = link.prev;
+    if (current_queue == qid_)
+        current_queue = link.next;
+}
+
+void zmq::api_thread_t::process_commands (signals_t &signals_)
+{
+    int source_thread_id;
+    while ((source_thread_id = signals_.pop ()) != -1) {
+        command_t command;
+        while (dispatcher->read (source_thread_id, thread_id, &command))
+            process_command (command);
+    }
+
+    //  Forward messages sent to the shared exchanges by other threads.
+    //  This is done on each wake-up as the pipe limits may have changed.
+    for (shared_exchanges_t::iterator it = shared_exchanges.begin ();
+          it != shared_exchanges.end (); it ++)
+        (*it)->forward ();
 }
 
 void zmq::api_thread_t::process_commands ()
@@ -413,17 +835,7 @@ void zmq::api_thread_t::process_commands ()
     //  It's ~1ms on 3GHz CPU, ~2ms on 1.5GHz CPU etc.
 
 	//  Get timestamp counter.
-#if defined __GNUC__
-    uint32_t low;
-    uint32_t high;
-    __asm__ volatile ("rdtsc"
-        : "=a" (low), "=d" (high));
-    uint64_t current_time = (uint64_t) high << 32 | low;
-#elif defined _MSC_VER
-    uint64_t current_time = __rdtsc ();
-#else
-#error
-#endif
+    uint64_t current_time = get_ticks ();
 
 	//  Check whether certain time have elapsed since last command processing.
     if (current_time - last_command_time <= api_thread_max_command_delay)
@@ -431,7 +843,7 @@ void zmq::api_thread_t::process_commands ()
     last_command_time = current_time;
 #endif
 
-    ypollset_t::integer_t signals = pollset.check ();
-    if (signals)
+    signals_t signals;
+    if (pollset.check (signals))
         process_commands (signals);
 }
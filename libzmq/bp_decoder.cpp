@@ -21,7 +21,8 @@
 #include <zmq/wire.hpp>
 
 zmq::bp_decoder_t::bp_decoder_t (i_demux *demux_) :
-    demux (demux_)
+    demux (demux_),
+    sliced (false)
 {
     //  At the beginning, read one byte and go to one_byte_size_ready state.
     next_step (tmpbuf, 1, &bp_decoder_t::one_byte_size_ready);
@@ -43,10 +44,8 @@ bool zmq::bp_decoder_t::one_byte_size_ready ()
     //  message data into it.
     if (*tmpbuf == 0xff)
         next_step (tmpbuf, 8, &bp_decoder_t::eight_byte_size_ready);
-    else {
-        message.rebuild (*tmpbuf);
-        next_step (message.data (), *tmpbuf, &bp_decoder_t::message_ready);
-    }
+    else
+        body_ready (*tmpbuf);
     return true;
 }
 
@@ -54,11 +53,44 @@ bool zmq::bp_decoder_t::eight_byte_size_ready ()
 {
     //  8-byte size is read. Allocate the buffer for message body and
     //  read the message data into it.
-    message.rebuild ((size_t) get_uint64 (tmpbuf));
-    next_step (message.data (), message.size (), &bp_decoder_t::message_ready);
+    body_ready ((size_t) get_uint64 (tmpbuf));
     return true;
 }
 
+void zmq::bp_decoder_t::body_ready (size_t size_)
+{
+    //  If the whole message body is already in the buffer obtained by
+    //  'get_buffer' and the message is not a VSM, make the message reference
+    //  the data in the buffer and skip the body.
+    unsigned char *body = in_place (size_);
+    if (body && size_ > max_vsm_size && buffer.size () > max_vsm_size &&
+          body >= (unsigned char*) buffer.data () &&
+          body + size_ <= (unsigned char*) buffer.data () + buffer.size ()) {
+        raw_message_slice ((raw_message_t*) &buffer,
+            (raw_message_t*) &message,
+            body - (unsigned char*) buffer.data (), size_);
+        sliced = true;
+        next_step (NULL, size_, &bp_decoder_t::message_ready);
+        return;
+    }
+
+    //  Otherwise allocate the buffer for message body and copy the data
+    //  into it.
+    message.rebuild (size_);
+    next_step (message.data (), size_, &bp_decoder_t::message_ready);
+}
+
+unsigned char *zmq::bp_decoder_t::get_buffer (size_t size_)
+{
+    //  Allocate new buffer if the old one is still referenced by some
+    //  messages or if it has different size.
+    if (sliced || buffer.size () != size_) {
+        buffer.rebuild (size_);
+        sliced = false;
+    }
+    return (unsigned char*) buffer.data ();
+}
+
 bool zmq::bp_decoder_t::message_ready ()
 {
     //  Message is completely read. Push it to the dispatcher and start reading
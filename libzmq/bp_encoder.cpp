@@ -21,7 +21,9 @@
 #include <zmq/wire.hpp>
 
 zmq::bp_encoder_t::bp_encoder_t (mux_t *mux_) :
-    mux (mux_)
+    mux (mux_),
+    current (0),
+    held (0)
 {
     //  Write 0 bytes to the batch and go to message_ready state.
     next_step (NULL, 0, &bp_encoder_t::message_ready, true);
@@ -29,8 +31,11 @@ zmq::bp_encoder_t::bp_encoder_t (mux_t *mux_) :
 
 void zmq::bp_encoder_t::reset ()
 {
-    //  Free the message buffer.
-    message.rebuild (0);
+    //  Free the message buffers.
+    for (int i = 0; i != max_io_vectors + 1; i ++)
+        messages [i].rebuild (0);
+    current = 0;
+    held = 0;
 
     //  Restart the FSM.
     next_step (NULL, 0, &bp_encoder_t::message_ready, true);
@@ -39,7 +44,9 @@ void zmq::bp_encoder_t::reset ()
 bool zmq::bp_encoder_t::size_ready ()
 {
     //  Write message body into the buffer.
-    next_step (message.data (), message.size (), &bp_encoder_t::message_ready, false);
+    message_t &message = messages [current];
+    next_step (message.data (), message.size (), &bp_encoder_t::message_ready,
+        false);
     return true;
 }
 
@@ -49,6 +56,7 @@ bool zmq::bp_encoder_t::message_ready ()
     //  Note that new state is set only if write is successful. That way
     //  unsuccessful write will cause retry on the next state machine
     //  invocation.
+    message_t &message = messages [current];
     if (!mux->read (&message))
         return false;
 
@@ -66,3 +74,17 @@ bool zmq::bp_encoder_t::message_ready ()
     }
     return true;
 }
+
+void zmq::bp_encoder_t::hold ()
+{
+    assert (held < max_io_vectors);
+    held ++;
+    current = (current + 1) % (max_io_vectors + 1);
+}
+
+void zmq::bp_encoder_t::release ()
+{
+    for (; held; held --)
+        messages [(current + max_io_vectors + 1 - held) %
+            (max_io_vectors + 1)].rebuild (0);
+}
@@ -213,6 +213,12 @@ void zmq::bp_pgm_receiver_t::unregister_event ()
     // TODO: Implement this. For now we just ignore the event.
 }
 
+bool zmq::bp_pgm_receiver_t::detach_event ()
+{
+    //  Moving the engine to a different I/O thread is not supported.
+    return false;
+}
+
 void zmq::bp_pgm_receiver_t::send_to (pipe_t *pipe_)
 {
     //  If pipe limits are set, POLLIN may be turned off
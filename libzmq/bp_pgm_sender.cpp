@@ -224,6 +224,12 @@ void zmq::bp_pgm_sender_t::unregister_event ()
     // TODO: Implement this. For now we just ignore the event.
 }
 
+bool zmq::bp_pgm_sender_t::detach_event ()
+{
+    //  Moving the engine to a different I/O thread is not supported.
+    return false;
+}
+
 void zmq::bp_pgm_sender_t::receive_from (pipe_t *pipe_)
 {    
     engine_base_t <false, true>::receive_from (pipe_);
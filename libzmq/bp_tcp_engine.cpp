@@ -21,13 +21,17 @@
 #include <zmq/dispatcher.hpp>
 #include <zmq/err.hpp>
 #include <zmq/config.hpp>
+#include <zmq/engine_options.hpp>
+#include <zmq/counters.hpp>
 
 zmq::bp_tcp_engine_t::bp_tcp_engine_t (i_thread *calling_thread_,
       i_thread *thread_, const char *hostname_, const char *local_object_,
-      const char * /* arguments_*/) :
+      const char *arguments_) :
     writebuf_size (bp_out_batch_size),
     write_size (0),
     write_pos (0),
+    iov_count (0),
+    iov_pos (0),
     readbuf_size (bp_in_batch_size),
     read_size (0),
     read_pos (0),
@@ -38,14 +42,15 @@ zmq::bp_tcp_engine_t::bp_tcp_engine_t (i_thread *calling_thread_,
     local_object (local_object_),
     reconnect_flag (true),
     state (engine_connecting),
-    socket (hostname_)
+    socket (hostname_),
+    zero_copy_in (false),
+    read_budget (bp_read_budget),
+    write_budget (bp_write_budget),
+    edge_triggered (bp_edge_triggered),
+    in_batch (true, bp_in_batch_size, bp_min_batch_size, bp_max_batch_size),
+    out_batch (false, bp_out_batch_size, bp_min_batch_size, bp_max_batch_size)
 {
-    
-    //  Allocate read and write buffers.
-    writebuf = (unsigned char*) malloc (writebuf_size);
-    errno_assert (writebuf);
-    readbuf = (unsigned char*) malloc (readbuf_size);
-    errno_assert (readbuf);
+    init (arguments_);
 
     //  Register BP engine with the I/O thread.
     command_t command;
@@ -54,10 +59,13 @@ zmq::bp_tcp_engine_t::bp_tcp_engine_t (i_thread *calling_thread_,
 }
 
 zmq::bp_tcp_engine_t::bp_tcp_engine_t (i_thread *calling_thread_,
-      i_thread *thread_, fd_t fd_, const char *local_object_) :
+      i_thread *thread_, fd_t fd_, const char *local_object_,
+      const char *arguments_) :
     writebuf_size (bp_out_batch_size),
     write_size (0),
     write_pos (0),
+    iov_count (0),
+    iov_pos (0),
     readbuf_size (bp_in_batch_size),
     read_size (0),
     read_pos (0),
@@ -68,13 +76,15 @@ zmq::bp_tcp_engine_t::bp_tcp_engine_t (i_thread *calling_thread_,
     local_object (local_object_),
     reconnect_flag (false),
     state (engine_connected),
-    socket (fd_)
+    socket (fd_),
+    zero_copy_in (false),
+    read_budget (bp_read_budget),
+    write_budget (bp_write_budget),
+    edge_triggered (bp_edge_triggered),
+    in_batch (true, bp_in_batch_size, bp_min_batch_size, bp_max_batch_size),
+    out_batch (false, bp_out_batch_size, bp_min_batch_size, bp_max_batch_size)
 {
-    //  Allocate read and write buffers.
-    writebuf = (unsigned char*) malloc (writebuf_size);
-    errno_assert (writebuf);
-    readbuf = (unsigned char*) malloc (readbuf_size);
-    errno_assert (readbuf);
+    init (arguments_);
 
     //  Register BP/TCP engine with the I/O thread.
     command_t command;
@@ -84,10 +94,38 @@ zmq::bp_tcp_engine_t::bp_tcp_engine_t (i_thread *calling_thread_,
 
 zmq::bp_tcp_engine_t::~bp_tcp_engine_t ()
 {
-    free (readbuf);
+    if (!zero_copy_in)
+        free (readbuf);
     free (writebuf);
 }
 
+void zmq::bp_tcp_engine_t::init (const char *arguments_)
+{
+    engine_options_t options (arguments_);
+    zero_copy_in = options.get ("zero_copy_in", 0) != 0;
+    read_budget = (size_t) options.get ("read_budget", bp_read_budget);
+    write_budget = (size_t) options.get ("write_budget", bp_write_budget);
+    edge_triggered = options.get ("edge_triggered", bp_edge_triggered) != 0;
+    in_batch.set_bounds (
+        (size_t) options.get ("in_batch_min", bp_min_batch_size),
+        (size_t) options.get ("in_batch_max", bp_max_batch_size));
+    out_batch.set_bounds (
+        (size_t) options.get ("out_batch_min", bp_min_batch_size),
+        (size_t) options.get ("out_batch_max", bp_max_batch_size));
+    writebuf_size = out_batch.size ();
+    readbuf_size = in_batch.size ();
+
+    //  Allocate read and write buffers. In zero-copy mode read buffers
+    //  are supplied by the decoder.
+    writebuf = (unsigned char*) malloc (writebuf_size);
+    errno_assert (writebuf);
+    readbuf = NULL;
+    if (!zero_copy_in) {
+        readbuf = (unsigned char*) malloc (readbuf_size);
+        errno_assert (readbuf);
+    }
+}
+
 void zmq::bp_tcp_engine_t::error ()
 {
     if (state == engine_connected) {
@@ -134,7 +172,7 @@ void zmq::bp_tcp_engine_t::reconnect ()
     //  failed. We are going to wait a while before trying to reconnect anew
     //  to prevent reconnect consuming 100% of the processor time.
     if (state == engine_connecting) {
-        poller->add_timer (this);
+        poller->add_timer (this, reconnect_period);
         state = engine_waiting_for_reconnect;
         return;
     }
@@ -144,7 +182,7 @@ void zmq::bp_tcp_engine_t::reconnect ()
     //  it anew.
     socket.reopen (); 
     if (socket.get_fd () == retired_fd) {
-        poller->add_timer (this);
+        poller->add_timer (this, reconnect_period);
         state = engine_waiting_for_reconnect;
         return;
     }
@@ -195,7 +233,7 @@ void zmq::bp_tcp_engine_t::register_event (i_poller *poller_)
 
     //  If initial attemp to connect failed, schedule reconnect.
     if (socket.get_fd () == retired_fd) {
-        poller->add_timer (this);
+        poller->add_timer (this, reconnect_period);
         state = engine_waiting_for_reconnect;
         return;
     }
@@ -206,9 +244,22 @@ void zmq::bp_tcp_engine_t::register_event (i_poller *poller_)
     if (state == engine_connecting)
         //  Wait for completion of connect() call.
         poller->set_pollout (handle);
-    else if (pipe_cnt > 0)
-        //  Start receiving 'backend protocol' messages.
-        poller->set_pollin (handle);
+    else {
+
+        //  Start receiving 'backend protocol' messages. If the engine was
+        //  moved from a different I/O thread, there may be data waiting
+        //  to be sent as well.
+        if (pipe_cnt > 0) {
+            poller->set_pollin (handle);
+            poller->set_pollout (handle);
+        }
+
+        //  Connection is already established, so it's safe to switch to
+        //  edge-triggered mode. (While connecting any notification
+        //  would be considered to be the completion of the connect.)
+        if (edge_triggered)
+            poller->set_edge_triggered (handle);
+    }
 }
 
 void zmq::bp_tcp_engine_t::in_event ()
@@ -221,53 +272,94 @@ void zmq::bp_tcp_engine_t::in_event ()
         return;
     }
 
-    //  This variable determines whether processing incoming messages is
-    //  stuck because of exceeded pipe limits.
-    bool stuck = read_pos < read_size;
-
-    //  If there's no data to process in the buffer, read new data.
-    if (read_pos == read_size) {
-
-        //  Read as much data as possible to the read buffer.
-        read_size = socket.read (readbuf, readbuf_size);
-        read_pos = 0;
+    //  Number of bytes read from the socket during this event.
+    size_t bytes_read = 0;
+
+    while (true) {
+
+        //  This variable determines whether processing incoming messages is
+        //  stuck because of exceeded pipe limits.
+        bool stuck = read_pos < read_size;
+
+        //  If there's no data to process in the buffer, read new data.
+        if (read_pos == read_size) {
+
+            //  In zero-copy mode the buffer may still be referenced by
+            //  messages decoded from it. Get a buffer that's safe to
+            //  overwrite. Otherwise resize the buffer if the batch size
+            //  have changed.
+            if (zero_copy_in) {
+                readbuf_size = in_batch.size ();
+                readbuf = decoder.get_buffer (readbuf_size);
+            }
+            else if (readbuf_size != (int) in_batch.size ()) {
+                readbuf_size = in_batch.size ();
+                readbuf = (unsigned char*) realloc (readbuf, readbuf_size);
+                errno_assert (readbuf);
+            }
+
+            //  Read as much data as possible to the read buffer.
+            if (bytes_read)
+                counter_add (counter_speculative_reads, 1);
+            counter_add (counter_socket_reads, 1);
+            read_size = socket.read (readbuf, readbuf_size);
+            read_pos = 0;
+
+            //  Check whether the peer has closed the connection.
+            if (read_size == -1) {
+                error ();
+                return;
+            }
+
+            //  Adjust the batch size to the amount of data available.
+            in_batch.update (read_size);
+            bytes_read += read_size;
+        }
 
-        //  Check whether the peer has closed the connection.
-        if (read_size == -1) {
-            error ();
-            return;
+        //  If there's at least one unprocessed byte in the buffer,
+        //  process it.
+        if (read_pos < read_size) {
+
+            //  Push the data to the decoder and adjust read position in
+            //  the buffer.
+            int nbytes = decoder.write (readbuf + read_pos,
+                read_size - read_pos);
+            read_pos += nbytes;
+
+            //  If processing was stuck and become unstuck start reading
+            //  from the socket. If it was unstuck and became stuck, stop
+            //  polling for new data.
+            if (stuck) {
+                if (read_pos == read_size)
+                    poller->set_pollin (handle);
+            }
+            else {
+                if (read_pos < read_size)
+                    poller->reset_pollin (handle);
+            }
+
+            //  If at least one byte was processed, flush any messages
+            //  decoder may have produced.
+            if (nbytes > 0)
+                demux->flush ();
         }
-    }
 
-    //  If there's at least one unprocessed byte in the buffer, process it.
-    if (read_pos < read_size) {
-
-        //  Push the data to the decoder and adjust read position in the buffer.
-        int  nbytes = decoder.write (readbuf + read_pos, read_size - read_pos);
-        read_pos += nbytes;
-
-         //  If processing was stuck and become unstuck start reading
-         //  from the socket. If it was unstuck and became stuck, stop polling
-         //  for new data.
-         if (stuck) {
-             if (read_pos == read_size)
-
-                 //  TODO: Speculative read should be used at this place to
-                 //  avoid excessive poll. However, it looks like this can
-                 //  result in infinite cycle in some cases, virtually
-                 //  preventing other engines' access to CPU. Fix it.
-                 poller->set_pollin (handle);
-         }
-         else {
-             if (read_pos < read_size) {
-                 poller->reset_pollin (handle);
-             }    
-         }
-
-        //  If at least one byte was processed, flush any messages decoder
-        //  may have produced.
-        if (nbytes > 0)
-            demux->flush ();
+        //  Speculatively read more data only if everything read so far
+        //  was processed and the last read filled the whole buffer, i.e.
+        //  there are probably more data waiting in the socket. Stop once
+        //  the read budget is exhausted so that an engine with continuous
+        //  stream of data cannot starve other engines in the same thread.
+        if (read_pos < read_size || read_size < readbuf_size)
+            break;
+        if (bytes_read >= read_budget) {
+            if (read_budget)
+                counter_add (counter_read_budget_hits, 1);
+
+            //  In edge-triggered mode there would be no notification about
+            //  the data left in the socket. Ask for one explicitly.
+            poller->set_pollin (handle);
+            break;
+        }
     }
 }
 
@@ -284,26 +376,58 @@ void zmq::bp_tcp_engine_t::out_event ()
             poller->reset_pollout (handle);
         if (pipe_cnt > 0)
             poller->set_pollin (handle);
+        if (edge_triggered)
+            poller->set_edge_triggered (handle);
         state = engine_connected;
         return;
     }
 
-    //  If write buffer is empty, try to read new data from the encoder.
-    if (write_pos == write_size) {
-
-        write_size = encoder.read (writebuf, writebuf_size);
-        write_pos = 0;
-
-        //  If there is no data to send, stop polling for output.
-        if (write_size == 0)
-            poller->reset_pollout (handle);
-    }
+    //  Number of bytes written to the socket during this event.
+    size_t bytes_written = 0;
+
+    while (true) {
+
+        //  If write buffer is empty, try to read new data from the encoder.
+        //  Message bodies referenced from the previous batch are released
+        //  at this point as the kernel has already accepted all of them.
+        if (write_pos == write_size) {
+
+            //  Resize the buffer if the batch size have changed.
+            if (writebuf_size != (int) out_batch.size ()) {
+                writebuf_size = out_batch.size ();
+                writebuf = (unsigned char*) realloc (writebuf, writebuf_size);
+                errno_assert (writebuf);
+            }
+
+            iov_count = encoder.read_iov (writebuf, writebuf_size, iov,
+                max_io_vectors);
+            iov_pos = 0;
+            write_size = 0;
+            size_t copied = 0;
+            for (int i = 0; i != iov_count; i ++) {
+                write_size += iov [i].size;
+                if (iov [i].data >= writebuf &&
+                      iov [i].data < writebuf + writebuf_size)
+                    copied += iov [i].size;
+            }
+            write_pos = 0;
+
+            //  If there is no data to send, stop polling for output.
+            if (write_size == 0) {
+                poller->reset_pollout (handle);
+                break;
+            }
+
+            //  Adjust the batch size to the amount of data available.
+            //  Message bodies referenced directly don't occupy the buffer,
+            //  so only the data copied into the buffer are taken into
+            //  account.
+            out_batch.update (copied);
+        }
 
-    //  If there are any data to write in write buffer, write as much as
-    //  possible to the socket.
-    if (write_pos < write_size) {
-        int nbytes = socket.write (writebuf + write_pos,
-            write_size - write_pos);
+        //  Write as much data as possible to the socket.
+        counter_add (counter_socket_writes, 1);
+        int nbytes = socket.writev (iov + iov_pos, iov_count - iov_pos);
 
         //  Handle problems with the connection.
         if (nbytes == -1) {
@@ -312,6 +436,33 @@ void zmq::bp_tcp_engine_t::out_event ()
         }
 
         write_pos += nbytes;
+        bytes_written += nbytes;
+
+        //  Drop the data blocks that were written completely and adjust
+        //  the one that was written partially.
+        while (nbytes) {
+            if ((size_t) nbytes >= iov [iov_pos].size) {
+                nbytes -= iov [iov_pos].size;
+                iov_pos ++;
+            }
+            else {
+                iov [iov_pos].data += nbytes;
+                iov [iov_pos].size -= nbytes;
+                nbytes = 0;
+            }
+        }
+
+        //  If the socket haven't accepted all the data, wait for it to
+        //  become writable again. Otherwise go on with the next batch
+        //  unless the write budget is exhausted. In the latter case ask
+        //  for a new notification explicitly as there would be none in
+        //  edge-triggered mode.
+        if (write_pos < write_size)
+            break;
+        if (bytes_written >= write_budget) {
+            poller->set_pollout (handle);
+            break;
+        }
     }
 }
 
@@ -332,6 +483,29 @@ void zmq::bp_tcp_engine_t::unregister_event ()
     }
 }
 
+bool zmq::bp_tcp_engine_t::detach_event ()
+{
+    //  Only engines created by a listener can be moved. These are attached
+    //  to a single pipe, so once the pipe is there no other thread is going
+    //  to attach a pipe to the engine while it is being moved. Reconnecting
+    //  engines are left alone as they rely on timers.
+    if (reconnect_flag || state != engine_connected || pipe_cnt == 0)
+        return false;
+
+    //  Pipes being shut down can't be redirected to the new thread as
+    //  the engine on the other end may be gone already.
+    std::vector <pipe_t*> pipes;
+    get_pipes (pipes);
+    for (std::vector <pipe_t*>::iterator it = pipes.begin ();
+          it != pipes.end (); it ++)
+        if ((*it)->is_terminating (this))
+            return false;
+
+    poller->rm_fd (handle);
+    poller = NULL;
+    return true;
+}
+
 void zmq::bp_tcp_engine_t::revive (pipe_t *pipe_)
 {
     //  Mark pipe as alive.
@@ -26,14 +26,16 @@ zmq::bp_tcp_listener_t::bp_tcp_listener_t (i_thread *calling_thread_,
       i_thread *thread_, const char *interface_, int handler_thread_count_,
       i_thread **handler_threads_, bool source_,
       i_thread *peer_thread_, i_engine *peer_engine_,
-      const char *peer_name_) :
+      const char *peer_name_, const char *engine_options_) :
     source (source_),
     poller (NULL),
     peer_thread (peer_thread_),
     peer_engine (peer_engine_),
     listener (interface_)
 {
-    //  Copy the peer name.
+    //  Copy the peer name and the options for the engines.
+    if (engine_options_)
+        engine_options = engine_options_;
     zmq_strncpy (peer_name, peer_name_, sizeof (peer_name));
 
     //  Initialise the array of threads to handle new connections.
@@ -89,7 +91,8 @@ void zmq::bp_tcp_listener_t::in_event ()
         return;
 
     bp_tcp_engine_t *engine = new bp_tcp_engine_t (poller,
-        handler_threads [current_handler_thread], fd, peer_name);
+        handler_threads [current_handler_thread], fd, peer_name,
+        engine_options.c_str ());
     assert (engine);
 
     if (source) {
@@ -166,6 +169,12 @@ void zmq::bp_tcp_listener_t::unregister_event ()
     listener.close ();
 }
 
+bool zmq::bp_tcp_listener_t::detach_event ()
+{
+    //  Moving the engine to a different I/O thread is not supported.
+    return false;
+}
+
 const char *zmq::bp_tcp_listener_t::get_arguments ()
 {
     zmq_snprintf (arguments, sizeof (arguments), "zmq.tcp://%s",
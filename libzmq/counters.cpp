@@ -0,0 +1,65 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+
+#include <zmq/counters.hpp>
+#include <zmq/atomic_counter.hpp>
+#include <zmq/config.hpp>
+
+#if defined ZMQ_HAVE_COUNTERS
+
+namespace zmq
+{
+    //  Each counter is placed on a separate cache line so that threads
+    //  updating different counters don't contend for the same line.
+    struct counter_t
+    {
+        atomic_counter_t value;
+        unsigned char pad [cache_line_size];
+    };
+
+    static counter_t counters [counter_count];
+}
+
+void zmq::counter_add (counter_id_t id_, uint32_t value_)
+{
+    counters [id_].value.add (value_);
+}
+
+void zmq::counter_sub (counter_id_t id_, uint32_t value_)
+{
+    counters [id_].value.sub (value_);
+}
+
+uint32_t zmq::counter_get (counter_id_t id_)
+{
+    assert (id_ < counter_count);
+    return counters [id_].value.get ();
+}
+
+#else
+
+uint32_t zmq::counter_get (counter_id_t id_)
+{
+    assert (id_ < counter_count);
+    return 0;
+}
+
+#endif
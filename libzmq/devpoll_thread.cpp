@@ -121,7 +121,13 @@ void zmq::devpoll_t::reset_pollout (handle_t handle_)
     devpoll_ctl (fd, fd_table [fd].events);
 }
 
-bool zmq::devpoll_t::process_events (poller_t <devpoll_t> *poller_, bool timers_)
+void zmq::devpoll_t::set_edge_triggered (handle_t)
+{
+    //  Edge-triggered notifications are not supported by /dev/poll.
+}
+
+bool zmq::devpoll_t::process_events (poller_t <devpoll_t> *poller_,
+    int timeout_)
 {
     struct pollfd ev_buf [max_io_events];
     struct dvpoll poll_req;
@@ -138,7 +144,7 @@ bool zmq::devpoll_t::process_events (poller_t <devpoll_t> *poller_, bool timers_
 
     poll_req.dp_fds = &ev_buf [0];
     poll_req.dp_nfds = nfds;
-    poll_req.dp_timeout = timers_ ? max_timer_period : -1;
+    poll_req.dp_timeout = timeout_;
 
     //  Wait for events.
     int n;
@@ -150,11 +156,9 @@ bool zmq::devpoll_t::process_events (poller_t <devpoll_t> *poller_, bool timers_
         }
     }
 
-    //  Handle timer.
-    if (!n) {
-        poller_->timer_event ();
+    //  Timeout expired. Timers are handled by the poller.
+    if (!n)
         return false;
-    }
 
     for (int i = 0; i < n; i ++) {
         fd_t fd = ev_buf [i].fd;
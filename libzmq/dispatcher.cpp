@@ -24,16 +24,29 @@
 #include <zmq/dispatcher.hpp>
 #include <zmq/err.hpp>
 #include <zmq/engine_factory.hpp>
+#include <zmq/signal_set.hpp>
 
 
-zmq::dispatcher_t::dispatcher_t (int thread_count_) :
+zmq::dispatcher_t::dispatcher_t (int thread_count_, bool message_pool_) :
     thread_count (thread_count_),
+    message_pool (NULL),
     signalers (thread_count, (i_signaler*) NULL),
     used (thread_count, false)
 {
-    //  Alocate NxN matrix of dispatching pipes.
-    pipes = new command_pipe_t [thread_count * thread_count];
-    assert (pipes);
+    //  Thread IDs are used as signals, so the number of threads is limited
+    //  by the number of distinct signals.
+    assert (thread_count > 0 && thread_count <= signal_set_t::max_signals);
+
+    //  Alocate the rows of the matrix of dispatching pipes. The rows
+    //  themselves are allocated on demand.
+    rows = new atomic_ptr_t <pipe_slot_t> [thread_count];
+    assert (rows);
+
+    //  Create the message pool, if required.
+    if (message_pool_) {
+        message_pool = new message_pool_t;
+        assert (message_pool);
+    }
 
 #ifdef ZMQ_HAVE_WINDOWS
 
@@ -60,7 +73,19 @@ zmq::dispatcher_t::~dispatcher_t ()
         (*it)->destroy ();
 
     //  Deallocate the pipe matrix.
-    delete [] pipes;
+    for (int source = 0; source != thread_count; source ++) {
+        pipe_slot_t *row = rows [source].get ();
+        if (!row)
+            continue;
+        for (int destination = 0; destination != thread_count; destination ++)
+            delete row [destination].get ();
+        delete [] row;
+    }
+    delete [] rows;
+
+    //  Deallocate the message pool.
+    if (message_pool)
+        delete message_pool;
 
 #ifdef ZMQ_HAVE_WINDOWS
 
@@ -70,6 +95,39 @@ zmq::dispatcher_t::~dispatcher_t ()
 #endif
 }
 
+zmq::dispatcher_t::command_pipe_t *zmq::dispatcher_t::create_pipe (
+    int source_thread_id_, int destination_thread_id_)
+{
+    //  Commands with the same source thread are normally written by a single
+    //  thread, however, 'stop' command is written to the thread's own pipe
+    //  by whoever shuts the dispatcher down. Thus, both the row and the pipe
+    //  are published using compare-and-swap. If another thread was faster,
+    //  its object is used instead.
+    pipe_slot_t *row = rows [source_thread_id_].get ();
+    if (!row) {
+        pipe_slot_t *new_row = new pipe_slot_t [thread_count];
+        assert (new_row);
+        row = rows [source_thread_id_].cas (NULL, new_row);
+        if (row)
+            delete [] new_row;
+        else
+            row = new_row;
+    }
+
+    command_pipe_t *pipe = row [destination_thread_id_].get ();
+    if (!pipe) {
+        command_pipe_t *new_pipe = new command_pipe_t;
+        assert (new_pipe);
+        pipe = row [destination_thread_id_].cas (NULL, new_pipe);
+        if (pipe)
+            delete new_pipe;
+        else
+            pipe = new_pipe;
+    }
+
+    return pipe;
+}
+
 int zmq::dispatcher_t::allocate_thread_id (i_thread *thread_,
     i_signaler *signaler_)
 {
@@ -52,9 +52,20 @@ zmq::i_engine *zmq::engine_factory_t::create_listener (
     }
 
     if (transport_type == "zmq.tcp") {
+
+        //  The interface may be followed by the options for the engines
+        //  handling the accepted connections, e.g. "eth0:5555 zero_copy_in=1".
+        std::string engine_options;
+        pos = transport_args.find (' ');
+        if (pos != std::string::npos) {
+            engine_options = transport_args.substr (pos + 1);
+            transport_args = transport_args.substr (0, pos);
+        }
+
         i_engine *engine = new bp_tcp_listener_t (calling_thread_, thread_,
             transport_args.c_str (), handler_thread_count_, handler_threads_,
-            source_, peer_thread_, peer_engine_, peer_name_);
+            source_, peer_thread_, peer_engine_, peer_name_,
+            engine_options.c_str ());
         assert (engine);
         return engine;
     }
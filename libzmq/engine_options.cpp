@@ -0,0 +1,62 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <sstream>
+
+#include <zmq/engine_options.hpp>
+
+zmq::engine_options_t::engine_options_t (const char *options_)
+{
+    if (!options_)
+        return;
+
+    std::istringstream in (options_);
+    std::string option;
+    while (in >> option) {
+
+        //  Options without '=' are ignored. Options with non-numeric value
+        //  are available only as strings.
+        std::string::size_type pos = option.find ('=');
+        if (pos == std::string::npos)
+            continue;
+        strings.insert (strings_t::value_type (option.substr (0, pos),
+            option.substr (pos + 1)));
+        std::istringstream value_in (option.substr (pos + 1));
+        int64_t value;
+        if (!(value_in >> value))
+            continue;
+        options [option.substr (0, pos)] = value;
+    }
+}
+
+int64_t zmq::engine_options_t::get (const char *name_, int64_t default_) const
+{
+    options_t::const_iterator it = options.find (name_);
+    return it == options.end () ? default_ : it->second;
+}
+
+void zmq::engine_options_t::get_all (const char *name_,
+    std::vector <std::string> &values_) const
+{
+    std::pair <strings_t::const_iterator, strings_t::const_iterator> range =
+        strings.equal_range (name_);
+    for (strings_t::const_iterator it = range.first; it != range.second;
+          it ++)
+        values_.push_back (it->second);
+}
@@ -27,6 +27,7 @@
 
 #include <zmq/err.hpp>
 #include <zmq/config.hpp>
+#include <zmq/counters.hpp>
 #include <zmq/epoll_thread.hpp>
 #include <zmq/fd.hpp>
 
@@ -49,6 +50,11 @@ zmq::handle_t zmq::epoll_t::add_fd (fd_t fd_, i_pollable *engine_)
     pe->fd = fd_;
     pe->ev.events = 0;
     pe->ev.data.ptr = pe;
+    pe->events = 0;
+    pe->ready = 0;
+    pe->is_ready = false;
+    pe->is_changed = false;
+    pe->edge_triggered = false;
     pe->engine = engine_;
 
     int rc = epoll_ctl (epoll_fd, EPOLL_CTL_ADD, fd_, &pe->ev);
@@ -71,81 +77,210 @@ void zmq::epoll_t::rm_fd (handle_t handle_)
 void zmq::epoll_t::set_pollin (handle_t handle_)
 {
     poll_entry_t *pe = (poll_entry_t*) handle_.ptr;
-    pe->ev.events |= EPOLLIN;
-    int rc = epoll_ctl (epoll_fd, EPOLL_CTL_MOD, pe->fd, &pe->ev);
-    errno_assert (rc != -1);
+    pe->events |= EPOLLIN;
+    if (pe->edge_triggered)
+        mark_ready (pe, EPOLLIN);
+    else
+        mark_changed (pe);
 }
 
 void zmq::epoll_t::reset_pollin (handle_t handle_)
 {
     poll_entry_t *pe = (poll_entry_t*) handle_.ptr;
-    pe->ev.events &= ~((short) EPOLLIN);
-    int rc = epoll_ctl (epoll_fd, EPOLL_CTL_MOD, pe->fd, &pe->ev);
-    errno_assert (rc != -1);
+    pe->events &= ~((uint32_t) EPOLLIN);
+    if (!pe->edge_triggered)
+        mark_changed (pe);
 }
 
 void zmq::epoll_t::set_pollout (handle_t handle_)
 {
     poll_entry_t *pe = (poll_entry_t*) handle_.ptr;
-    pe->ev.events |= EPOLLOUT;
-    int rc = epoll_ctl (epoll_fd, EPOLL_CTL_MOD, pe->fd, &pe->ev);
-    errno_assert (rc != -1);
+    pe->events |= EPOLLOUT;
+    if (pe->edge_triggered)
+        mark_ready (pe, EPOLLOUT);
+    else
+        mark_changed (pe);
 }
 
 void zmq::epoll_t::reset_pollout (handle_t handle_)
 {
     poll_entry_t *pe = (poll_entry_t*) handle_.ptr;
-    pe->ev.events &= ~((short) EPOLLOUT);
+    pe->events &= ~((uint32_t) EPOLLOUT);
+    if (!pe->edge_triggered)
+        mark_changed (pe);
+}
+
+void zmq::epoll_t::set_edge_triggered (handle_t handle_)
+{
+    poll_entry_t *pe = (poll_entry_t*) handle_.ptr;
+    if (pe->edge_triggered)
+        return;
+
+    //  Register for both input and output. From now on the registration
+    //  is never changed.
+    pe->edge_triggered = true;
+    pe->ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+    counter_add (counter_poller_changes, 1);
     int rc = epoll_ctl (epoll_fd, EPOLL_CTL_MOD, pe->fd, &pe->ev);
     errno_assert (rc != -1);
+
+    //  The socket may have become ready before the registration. Thus
+    //  we have to notify the engine about the events it is waiting for.
+    mark_ready (pe, pe->events);
+}
+
+void zmq::epoll_t::mark_changed (poll_entry_t *pe_)
+{
+    if (!pe_->is_changed) {
+        pe_->is_changed = true;
+        changed.push_back (pe_);
+    }
+}
+
+void zmq::epoll_t::mark_ready (poll_entry_t *pe_, uint32_t events_)
+{
+    if (!events_)
+        return;
+    if (!pe_->is_ready) {
+        pe_->is_ready = true;
+        ready.push_back (pe_);
+    }
+    pe_->ready |= events_;
+}
+
+void zmq::epoll_t::apply_changes ()
+{
+    for (entries_t::iterator it = changed.begin (); it != changed.end ();
+          it ++) {
+        poll_entry_t *pe = *it;
+        pe->is_changed = false;
+
+        //  If the events were switched on and off again, there's nothing
+        //  to do.
+        if (pe->fd == retired_fd || pe->edge_triggered ||
+              pe->ev.events == pe->events)
+            continue;
+
+        pe->ev.events = pe->events;
+        counter_add (counter_poller_changes, 1);
+        int rc = epoll_ctl (epoll_fd, EPOLL_CTL_MOD, pe->fd, &pe->ev);
+        errno_assert (rc != -1);
+    }
+    changed.clear ();
+}
+
+bool zmq::epoll_t::process_ready (poller_t <epoll_t> *poller_)
+{
+    //  Engines may schedule new events while being notified. Entries not
+    //  yet in the list are appended to it, those already present only have
+    //  their flags extended. Either way the events are delivered in the
+    //  next iteration.
+    size_t count = ready.size ();
+    for (size_t i = 0; i != count; i ++) {
+        poll_entry_t *pe = ready [i];
+        uint32_t events = pe->ready;
+        pe->ready = 0;
+
+        if (pe->fd == retired_fd)
+            continue;
+        if ((events & pe->events & EPOLLOUT))
+            if (poller_->process_event (pe->engine, event_out))
+                return true;
+        if (pe->fd == retired_fd)
+            continue;
+        if ((events & pe->events & EPOLLIN))
+            if (poller_->process_event (pe->engine, event_in))
+                return true;
+    }
+
+    //  Drop the entries that have nothing to deliver. Each entry is in the
+    //  list at most once so the list never grows beyond the number of
+    //  registered descriptors.
+    size_t pos = 0;
+    for (size_t i = 0; i != ready.size (); i ++) {
+        if (ready [i]->ready)
+            ready [pos ++] = ready [i];
+        else
+            ready [i]->is_ready = false;
+    }
+    ready.resize (pos);
+
+    return false;
 }
 
-bool zmq::epoll_t::process_events (poller_t <epoll_t> *poller_, bool timers_)
+void zmq::epoll_t::remove_retired (entries_t &entries_)
+{
+    size_t pos = 0;
+    for (size_t i = 0; i != entries_.size (); i ++)
+        if (entries_ [i]->fd != retired_fd)
+            entries_ [pos ++] = entries_ [i];
+    entries_.resize (pos);
+}
+
+bool zmq::epoll_t::process_events (poller_t <epoll_t> *poller_,
+    int timeout_)
 {
     epoll_event ev_buf [max_io_events];
 
-    //  Wait for events.
+    //  Pass the changes of the polling set to the kernel.
+    apply_changes ();
+
+    //  Wait for events. If there are events ready to be delivered already,
+    //  just check for new ones without blocking.
     int n;
     while (true) {
+        counter_add (counter_poller_waits, 1);
         n = epoll_wait (epoll_fd, &ev_buf [0], max_io_events,
-            timers_ ? max_timer_period : -1);
+            !ready.empty () ? 0 : timeout_);
         if (!(n == -1 && errno == EINTR)) {
            errno_assert (n != -1);
            break;
         }
     }
 
-    //  Handle timer.
-    if (!n) {
-        poller_->timer_event ();
+    //  Timeout expired. Timers are handled by the poller.
+    if (!n && ready.empty ())
         return false;
-    }
 
     for (int i = 0; i < n; i ++) {
         poll_entry_t *pe = ((poll_entry_t*) ev_buf [i].data.ptr);
 
+        //  Notifications about events the engine is not interested in
+        //  are ignored. In edge-triggered mode, the events already
+        //  reported by epoll don't have to be delivered once more.
+        uint32_t events = ev_buf [i].events;
+        pe->ready &= ~events;
+
         if (pe->fd == retired_fd)
             continue;
-        if (ev_buf [i].events & (EPOLLERR | EPOLLHUP))
+        if (events & (EPOLLERR | EPOLLHUP))
             if (poller_->process_event (pe->engine, event_err))
                 return true;
         if (pe->fd == retired_fd)
             continue;
-        if (ev_buf [i].events & EPOLLOUT)
+        if (events & pe->events & EPOLLOUT)
             if (poller_->process_event (pe->engine, event_out))
                 return true;
         if (pe->fd == retired_fd)
             continue;
-        if (ev_buf [i].events & EPOLLIN)
+        if (events & pe->events & EPOLLIN)
             if (poller_->process_event (pe->engine, event_in))
                 return true;
     }
 
+    //  Deliver the events scheduled by the engines.
+    if (process_ready (poller_))
+        return true;
+
     //  Destroy retired event sources.
-    for (retired_t::iterator it = retired.begin (); it != retired.end ();
-          it ++)
-        delete *it;
-    retired.clear ();
+    if (!retired.empty ()) {
+        remove_retired (changed);
+        remove_retired (ready);
+        for (entries_t::iterator it = retired.begin (); it != retired.end ();
+              it ++)
+            delete *it;
+        retired.clear ();
+    }
 
     return false;
 }
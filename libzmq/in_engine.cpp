@@ -18,30 +18,126 @@
 */
 
 #include <zmq/in_engine.hpp>
+#include <zmq/config.hpp>
 
 zmq::in_engine_t *zmq::in_engine_t::create (int64_t hwm_, int64_t lwm_,
-    uint64_t swap_size_)
+    uint64_t swap_size_, size_t conflate_size_)
 {
-    in_engine_t *instance = new in_engine_t (hwm_, lwm_, swap_size_);
+    in_engine_t *instance = new in_engine_t (hwm_, lwm_, swap_size_,
+        conflate_size_);
     assert (instance);
     return instance;
 }
 
 zmq::in_engine_t::in_engine_t (int64_t hwm_, int64_t lwm_,
-      int64_t swap_size_) :
+      int64_t swap_size_, size_t conflate_size_) :
     hwm (hwm_),
     lwm (lwm_),
-    swap_size (swap_size_)
+    swap_size (swap_size_),
+    conflate_size (conflate_size_),
+    head (0),
+    unkeyed (0),
+    index (0)
 {
 }
 
 zmq::in_engine_t::~in_engine_t ()
 {
+    for (std::deque <raw_message_t>::iterator it = buffer.begin ();
+          it != buffer.end (); it ++)
+        raw_message_destroy (&*it);
 }
 
 bool zmq::in_engine_t::read (message_t *msg_)
 {
-    return mux.read (msg_);
+    if (!conflate_size)
+        return mux.read (msg_);
+
+    //  Pass the oldest buffered message to the caller.
+    return read_batch (msg_, 1) == 1;
+}
+
+size_t zmq::in_engine_t::read_batch (message_t *msgs_, size_t max_)
+{
+    if (!conflate_size)
+        return mux.read_batch (msgs_, max_);
+
+    conflate ();
+
+    //  Pass the oldest buffered messages to the caller. The messages are
+    //  not going to be replaced any more, so forget their keys.
+    raw_message_t *msgs = (raw_message_t*) msgs_;
+    size_t count = 0;
+    for (; count != max_ && !buffer.empty (); count ++) {
+        raw_message_t *msg = &buffer.front ();
+        if (raw_message_type (msg) == 0 &&
+              raw_message_size (msg) >= conflate_size) {
+            keys_t::iterator it = keys.find (std::string ((const char*)
+                raw_message_data (msg), conflate_size));
+            if (it != keys.end () && it->second == head)
+                keys.erase (it);
+        }
+        else
+            unkeyed --;
+        raw_message_destroy (&msgs [count]);
+        msgs [count] = *msg;
+        buffer.pop_front ();
+        head ++;
+    }
+
+    //  Initialise the rest of the array to be 0-byte messages.
+    for (size_t i = count; i != max_; i ++) {
+        raw_message_destroy (&msgs [i]);
+        raw_message_init (&msgs [i], 0);
+    }
+
+    return count;
+}
+
+bool zmq::in_engine_t::ready ()
+{
+    return !buffer.empty () || mux.ready ();
+}
+
+void zmq::in_engine_t::conflate ()
+{
+    message_t msg;
+    raw_message_t *raw = (raw_message_t*) &msg;
+    for (int i = 0; i != max_conflate_batch; i ++) {
+
+        //  Messages that are never replaced are bound by the high water mark
+        //  of the queue. Once there are that many in the buffer, leave
+        //  the rest in the pipes so that the writers are held back.
+        if (hwm > 0 && unkeyed >= (uint64_t) hwm)
+            break;
+
+        if (!mux.read (&msg))
+            break;
+
+        //  Notifications and messages too short to have a key are queued
+        //  as they are.
+        if (raw_message_type (raw) != 0 ||
+              raw_message_size (raw) < conflate_size) {
+            buffer.push_back (*raw);
+            unkeyed ++;
+            raw_message_init (raw, 0);
+            continue;
+        }
+
+        //  If there's an unread message with the same key, replace it.
+        //  Otherwise queue the message.
+        std::pair <keys_t::iterator, bool> res = keys.insert (
+            keys_t::value_type (std::string ((const char*)
+            raw_message_data (raw), conflate_size), head + buffer.size ()));
+        if (res.second)
+            buffer.push_back (*raw);
+        else {
+            raw_message_t *old = &buffer [res.first->second - head];
+            raw_message_destroy (old);
+            *old = *raw;
+        }
+        raw_message_init (raw, 0);
+    }
 }
 
 void zmq::in_engine_t::get_watermarks (int64_t *hwm_, int64_t *lwm_)
@@ -0,0 +1,74 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <zmq/io_pool.hpp>
+#include <zmq/err.hpp>
+
+zmq::io_pool_t::io_pool_t (int thread_count_) :
+    thread_count (thread_count_)
+{
+    members = new member_t [thread_count];
+    assert (members);
+}
+
+zmq::io_pool_t::~io_pool_t ()
+{
+    delete [] members;
+}
+
+int zmq::io_pool_t::join (i_thread *thread_)
+{
+    int index = joined.add (1);
+    assert (index < thread_count);
+    members [index].thread.set (thread_);
+    return index;
+}
+
+void zmq::io_pool_t::set_load (int index_, uint32_t load_)
+{
+    members [index_].load.set (load_);
+}
+
+void zmq::io_pool_t::add_load (int index_, uint32_t load_)
+{
+    members [index_].load.add (load_);
+}
+
+int zmq::io_pool_t::get_least_loaded (int index_, uint32_t *load_)
+{
+    int result = -1;
+    for (int i = 0; i != thread_count; i ++) {
+
+        //  Threads that haven't joined yet are skipped.
+        if (i == index_ || !members [i].thread.get ())
+            continue;
+
+        uint32_t load = members [i].load.get ();
+        if (result == -1 || load < *load_) {
+            result = i;
+            *load_ = load;
+        }
+    }
+    return result;
+}
+
+zmq::i_thread *zmq::io_pool_t::get_thread (int index_)
+{
+    return members [index_].thread.get ();
+}
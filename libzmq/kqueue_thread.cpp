@@ -116,30 +116,33 @@ void zmq::kqueue_t::reset_pollout (handle_t handle_)
     kevent_delete (pe->fd, EVFILT_WRITE);
 }
 
-bool zmq::kqueue_t::process_events (poller_t <kqueue_t> *poller_, bool timers_)
+void zmq::kqueue_t::set_edge_triggered (handle_t)
+{
+    //  Edge-triggered notifications (EV_CLEAR) are not used with kqueue yet.
+}
+
+bool zmq::kqueue_t::process_events (poller_t <kqueue_t> *poller_,
+    int timeout_)
 {
     struct kevent ev_buf [max_io_events];
 
     //  Compute time interval to wait.
-    timespec timeout = {max_timer_period / 1000, 
-        (max_timer_period % 1000) * 1000000};
+    timespec timeout = {timeout_ / 1000, (timeout_ % 1000) * 1000000};
 
     //  Wait for events.
     int n;
     while (true) {
         n = kevent (kqueue_fd, NULL, 0,
-             &ev_buf [0], max_io_events, timers_ ? &timeout : NULL);
+             &ev_buf [0], max_io_events, timeout_ >= 0 ? &timeout : NULL);
         if (!(n == -1 && errno == EINTR)) {
             errno_assert (n != -1);
             break;
         }
     }
 
-    //  Handle timer.
-    if (!n) {
-        poller_->timer_event ();
+    //  Timeout expired. Timers are handled by the poller.
+    if (!n)
         return false;
-    }
 
     for (int i = 0; i < n; i ++) {
         poll_entry_t *pe = (poll_entry_t*) ev_buf [i].udata;
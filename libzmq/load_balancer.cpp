@@ -21,9 +21,13 @@
 #include <algorithm>
 #include <zmq/load_balancer.hpp>
 
-zmq::load_balancer_t::load_balancer_t () :
-    current (0)
+zmq::load_balancer_t::load_balancer_t (style_t style_) :
+    current (0),
+    style (style_),
+    seed (2463534242u)
 {
+    assert (style == style_load_balancing || style == style_least_loaded ||
+        style == style_two_choices);
 }
 
 zmq::load_balancer_t::~load_balancer_t ()
@@ -56,13 +60,17 @@ bool zmq::load_balancer_t::write (message_t &msg_)
     if (pipes.size () == 0)
         return false;
 
-    //  Find the first pipe that is ready to accept the message.
-    bool found = false;
-    for (pipes_t::size_type i = 0; !found && i < pipes.size (); i++) {
-        if (pipes [current]->check_write ())
-            found = true;
-        else
-            current = (current + 1) % pipes.size ();
+    //  Choose the pipe to send the message to.
+    bool found;
+    switch (style) {
+    case style_least_loaded:
+        found = choose_least_loaded ();
+        break;
+    case style_two_choices:
+        found = choose_two_choices ();
+        break;
+    default:
+        found = choose_round_robin ();
     }
 
     //  Oops, no pipe is ready to accept he message.
@@ -79,6 +87,75 @@ bool zmq::load_balancer_t::write (message_t &msg_)
     return true;
 }
 
+bool zmq::load_balancer_t::choose_round_robin ()
+{
+    //  Find the first pipe that is ready to accept the message.
+    for (pipes_t::size_type i = 0; i < pipes.size (); i++) {
+        if (pipes [current]->check_write ())
+            return true;
+        current = (current + 1) % pipes.size ();
+    }
+    return false;
+}
+
+bool zmq::load_balancer_t::choose_least_loaded ()
+{
+    //  Find the pipe with the fewest queued messages. Start at the pipe next
+    //  to the previously chosen one so that equally loaded pipes are used
+    //  in round-robin fashion.
+    bool found = false;
+    uint64_t min_queued = 0;
+    unsigned chosen = current;
+    for (pipes_t::size_type i = 0; i < pipes.size (); i++) {
+        pipe_t *pipe = pipes [current];
+        if (pipe->check_write () &&
+              (!found || pipe->get_queued () < min_queued)) {
+            found = true;
+            min_queued = pipe->get_queued ();
+            chosen = current;
+            if (!min_queued)
+                break;
+        }
+        current = (current + 1) % pipes.size ();
+    }
+    current = chosen;
+    return found;
+}
+
+bool zmq::load_balancer_t::choose_two_choices ()
+{
+    //  Pick two pipes at random (xorshift generator), choose the one with
+    //  fewer queued messages.
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    unsigned first = seed % pipes.size ();
+    unsigned second = (seed >> 16) % pipes.size ();
+    bool first_ready = pipes [first]->check_write ();
+    bool second_ready = pipes [second]->check_write ();
+    if (first_ready && second_ready) {
+        current = pipes [first]->get_queued () <=
+            pipes [second]->get_queued () ? first : second;
+        return true;
+    }
+    if (first_ready || second_ready) {
+        current = first_ready ? first : second;
+        return true;
+    }
+
+    //  Both pipes are full. Fall back to any pipe that isn't.
+    current = second;
+    return choose_round_robin ();
+}
+
+size_t zmq::load_balancer_t::write_many (message_t *msgs_, size_t count_)
+{
+    size_t sent = 0;
+    while (sent != count_ && write (msgs_ [sent]))
+        sent ++;
+    return sent;
+}
+
 void zmq::load_balancer_t::flush ()
 {
     //  Flush all the present messages to the pipes.
@@ -97,6 +174,11 @@ bool zmq::load_balancer_t::empty ()
     return pipes.empty ();
 }
 
+void zmq::load_balancer_t::get_pipes (std::vector <pipe_t*> &pipes_)
+{
+    pipes_.insert (pipes_.end (), pipes.begin (), pipes.end ());
+}
+
 void zmq::load_balancer_t::release_pipe (pipe_t *pipe_)
 {
     //  Find the pipe.
@@ -0,0 +1,193 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <stdlib.h>
+
+#include <zmq/message_pool.hpp>
+#include <zmq/raw_message.hpp>
+#include <zmq/err.hpp>
+
+#if defined ZMQ_HAVE_MESSAGE_POOL
+__thread zmq::message_cache_t *zmq::message_cache_t::current = NULL;
+#endif
+
+zmq::message_cache_t::message_cache_t ()
+{
+    for (int i = 0; i != class_count; i ++) {
+        local [i] = NULL;
+        local_size [i] = 0;
+    }
+}
+
+zmq::message_cache_t::~message_cache_t ()
+{
+    for (int i = 0; i != class_count; i ++) {
+        free_list (local [i]);
+        free_list (remote [i].xchg (NULL));
+    }
+}
+
+zmq::message_content_t *zmq::message_cache_t::allocate (size_t size_)
+{
+    if (size_ > message_pool_max_size)
+        return NULL;
+    int cls = get_class (size_);
+
+    //  If there are no blocks available locally, take over the blocks
+    //  returned by other threads. Keep at most message_cache_max_blocks
+    //  of them, free the rest.
+    if (!local [cls]) {
+        block_t *list = remote [cls].xchg (NULL);
+        block_t **pos = &list;
+        int size = 0;
+        while (*pos && size != message_cache_max_blocks) {
+            pos = &(*pos)->next;
+            size ++;
+        }
+        free_list (*pos);
+        *pos = NULL;
+        local [cls] = list;
+        local_size [cls] = size;
+    }
+
+    //  If there is a free block available, use it.
+    block_t *block = local [cls];
+    if (block) {
+        local [cls] = block->next;
+        local_size [cls] --;
+    }
+    else {
+
+        //  Allocate the block large enough to hold any message
+        //  of the size class.
+        block = (block_t*) malloc (sizeof (message_content_t) +
+            (message_pool_min_size << cls));
+        errno_assert (block);
+    }
+
+    message_content_t *content = (message_content_t*) block;
+    content->cache = this;
+    return content;
+}
+
+void zmq::message_cache_t::deallocate (message_content_t *content_)
+{
+    message_cache_t *cache = content_->cache;
+    int cls = get_class (content_->size);
+    block_t *block = (block_t*) content_;
+
+#if defined ZMQ_HAVE_MESSAGE_POOL
+    //  Block is returned by the owner thread. If the local list is not full
+    //  yet, store it there. Otherwise, free it.
+    if (cache == current) {
+        if (cache->local_size [cls] == message_cache_max_blocks) {
+            free (block);
+            return;
+        }
+        block->next = cache->local [cls];
+        cache->local [cls] = block;
+        cache->local_size [cls] ++;
+        return;
+    }
+#endif
+
+    //  Block is returned by a different thread. Push it to the remote list.
+    block_t *head = NULL;
+    while (true) {
+        block->next = head;
+        block_t *old = cache->remote [cls].cas (head, block);
+        if (old == head)
+            break;
+        head = old;
+    }
+}
+
+int zmq::message_cache_t::get_class (size_t size_)
+{
+    int cls = 0;
+    while ((size_t) (message_pool_min_size << cls) < size_)
+        cls ++;
+    assert (cls < class_count);
+    return cls;
+}
+
+void zmq::message_cache_t::free_list (block_t *list_)
+{
+    while (list_) {
+        block_t *next = list_->next;
+        free (list_);
+        list_ = next;
+    }
+}
+
+zmq::message_pool_t::message_pool_t ()
+{
+}
+
+zmq::message_pool_t::~message_pool_t ()
+{
+    for (caches_t::iterator it = caches.begin (); it != caches.end (); it ++) {
+
+#if defined ZMQ_HAVE_MESSAGE_POOL
+        //  If the thread destroying the pool is still attached to it, detach
+        //  it so that subsequent allocations don't use the freed cache.
+        if (message_cache_t::current == *it)
+            message_cache_t::current = NULL;
+#endif
+
+        delete *it;
+    }
+}
+
+zmq::message_cache_t *zmq::message_pool_t::attach ()
+{
+#if defined ZMQ_HAVE_MESSAGE_POOL
+    message_cache_t *cache = NULL;
+
+    sync.lock ();
+    if (!unused.empty ()) {
+        cache = unused.back ();
+        unused.pop_back ();
+    }
+    else {
+        cache = new message_cache_t;
+        assert (cache);
+        caches.push_back (cache);
+    }
+    sync.unlock ();
+
+    message_cache_t::current = cache;
+    return cache;
+#else
+    return NULL;
+#endif
+}
+
+void zmq::message_pool_t::detach (message_cache_t *cache_)
+{
+#if defined ZMQ_HAVE_MESSAGE_POOL
+    //  If the thread has attached again in the meantime, the cache it uses
+    //  now is not affected.
+    if (message_cache_t::current == cache_)
+        message_cache_t::current = NULL;
+
+    sync.lock ();
+    unused.push_back (cache_);
+    sync.unlock ();
+#endif
+}
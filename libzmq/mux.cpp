@@ -21,7 +21,7 @@
 #include <zmq/raw_message.hpp>
 
 zmq::mux_t::mux_t () :
-    current (0)
+    top (0)
 {
 }
 
@@ -31,8 +31,36 @@ zmq::mux_t::~mux_t ()
 
 void zmq::mux_t::receive_from (pipe_t *pipe_)
 {
-    //  Associate new pipe with the mux object.
-    pipes.push_back (pipe_);
+    //  Associate new pipe with the mux object. New pipe is alive, so make
+    //  it active straight away.
+    classes_t::size_type pos = get_class (pipe_->get_priority ());
+    class_t &cls = classes [pos];
+    entry_t entry = {pipe_, pipe_->get_weight (), pipe_->get_weight (),
+        false, 0, 0};
+    pipe_->set_index (cls.pipes.size ());
+    cls.pipes.push_back (entry);
+    activate (cls, cls.pipes.size () - 1);
+    if (pos < top)
+        top = pos;
+}
+
+void zmq::mux_t::revive (pipe_t *pipe_)
+{
+    pipe_->revive ();
+
+    //  Schedule the pipe for reading once more.
+    classes_t::size_type pos = get_class (pipe_->get_priority ());
+    class_t &cls = classes [pos];
+    activate (cls, pipe_->get_index ());
+    if (pos < top)
+        top = pos;
+}
+
+bool zmq::mux_t::ready ()
+{
+    while (top != classes.size () && !classes [top].active)
+        top ++;
+    return top != classes.size ();
 }
 
 bool zmq::mux_t::read (message_t *msg_)
@@ -44,17 +72,32 @@ bool zmq::mux_t::read (message_t *msg_)
     //  Deallocate old content of the message.
     raw_message_destroy (msg);
 
-    //  Round-robin over the pipes to get next message.
-    for (int to_process = pipes.size (); to_process != 0; to_process --) {
+    //  Round-robin over the active pipes of the highest priority class that
+    //  has any to get next message.
+    while (ready ()) {
 
-        bool retrieved = pipes [current]->read ((raw_message_t*) msg_);
+        class_t &cls = classes [top];
+        entry_t &entry = cls.pipes [cls.current];
 
-        current ++;
-        if (current == pipes.size ())
-            current = 0;
+        //  Weighted pipe that has used up its share of bytes passes its turn
+        //  to the next pipe.
+        if (entry.weight && entry.deficit <= 0) {
+            skip (cls, entry);
+            continue;
+        }
 
-        if (retrieved)
+        if (entry.pipe->read (msg)) {
+            cls.skipped = 0;
+            if (entry.weight)
+                charge (entry, msg);
+            else
+                advance (cls);
             return true;
+        }
+
+        //  The pipe is empty. Don't visit it till it's revived.
+        entry.deficit = entry.weight;
+        deactivate (cls, cls.current);
     }
 
     //  No message is available. Initialise the output parameter
@@ -63,33 +106,219 @@ bool zmq::mux_t::read (message_t *msg_)
     return false;
 }
 
+size_t zmq::mux_t::read_batch (message_t *msgs_, size_t max_)
+{
+    raw_message_t *msgs = (raw_message_t*) msgs_;
+
+    //  Deallocate old content of the messages.
+    for (size_t i = 0; i != max_; i ++)
+        raw_message_destroy (&msgs [i]);
+
+    //  Round-robin over the active pipes of the highest priority class that
+    //  has any, draining each of them in turn.
+    size_t count = 0;
+    while (count != max_ && ready ()) {
+
+        class_t &cls = classes [top];
+        entry_t &entry = cls.pipes [cls.current];
+
+        if (entry.weight) {
+
+            //  Weighted pipe passes the messages one by one so that its
+            //  share of bytes is respected (see 'read' for details).
+            if (entry.deficit <= 0) {
+                skip (cls, entry);
+                continue;
+            }
+            if (entry.pipe->read (&msgs [count])) {
+                cls.skipped = 0;
+                charge (entry, &msgs [count]);
+                count ++;
+                continue;
+            }
+        }
+        else {
+            size_t retrieved = entry.pipe->read_batch (msgs + count,
+                max_ - count);
+            if (retrieved) {
+                cls.skipped = 0;
+                count += retrieved;
+                advance (cls);
+                continue;
+            }
+        }
+
+        //  The pipe is empty. Don't visit it till it's revived.
+        entry.deficit = entry.weight;
+        deactivate (cls, cls.current);
+    }
+
+    //  Initialise the rest of the array to be 0-byte messages.
+    for (size_t i = count; i != max_; i ++)
+        raw_message_init (&msgs [i], 0);
+
+    return count;
+}
+
 bool zmq::mux_t::empty ()
 {
-    return pipes.empty ();
+    for (classes_t::iterator it = classes.begin (); it != classes.end ();
+          it ++)
+        if (!it->pipes.empty ())
+            return false;
+    return true;
 }
 
-void zmq::mux_t::release_pipe (pipe_t *pipe_)
+void zmq::mux_t::get_pipes (std::vector <pipe_t*> &pipes_)
 {
-    for (pipes_t::iterator it = pipes.begin (); it != pipes.end (); it ++)
-        if (*it == pipe_) {
+    for (classes_t::iterator it = classes.begin (); it != classes.end ();
+          it ++)
+        for (entries_t::iterator eit = it->pipes.begin ();
+              eit != it->pipes.end (); eit ++)
+            pipes_.push_back (eit->pipe);
+}
 
-            //  At this point pipe is physically destroyed.
-            delete *it;
+void zmq::mux_t::release_pipe (pipe_t *pipe_)
+{
+    //  There's a bug in shut down mechanism if the pipe is not ours!
+    class_t &cls = classes [get_class (pipe_->get_priority ())];
+    size_t index = pipe_->get_index ();
+    assert (index < cls.pipes.size () && cls.pipes [index].pipe == pipe_);
 
-            //  Remove the pipe from the list.
-            pipes.erase (it);
-            if (current == pipes.size ())
-                current = 0;
-            return;
+    //  Remove the pipe from the list. Active pipe is unlinked from the ring
+    //  first. The last pipe in the list takes its place, so the links
+    //  pointing to the last pipe have to be adjusted.
+    if (cls.pipes [index].active)
+        deactivate (cls, index);
+    size_t last = cls.pipes.size () - 1;
+    if (index != last) {
+        entry_t entry = cls.pipes [last];
+        cls.pipes [index] = entry;
+        entry.pipe->set_index (index);
+        if (entry.active) {
+            if (entry.next == last) {
+                cls.pipes [index].prev = index;
+                cls.pipes [index].next = index;
+            }
+            else {
+                cls.pipes [entry.prev].next = index;
+                cls.pipes [entry.next].prev = index;
+            }
+            if (cls.current == last)
+                cls.current = index;
         }
+    }
+    cls.pipes.pop_back ();
 
-    //  There's a bug in shut down mechanism!
-    assert (false);
+    //  At this point pipe is physically destroyed.
+    delete pipe_;
 }
 
 void zmq::mux_t::initialise_shutdown ()
 {
     //  Broadcast 'terminate_reader' to all the pipes associated with the mux.
-    for (pipes_t::iterator it = pipes.begin (); it != pipes.end (); it ++)
-        (*it)->terminate_reader ();
+    for (classes_t::iterator it = classes.begin (); it != classes.end ();
+          it ++)
+        for (entries_t::iterator eit = it->pipes.begin ();
+              eit != it->pipes.end (); eit ++)
+            eit->pipe->terminate_reader ();
+}
+
+zmq::mux_t::classes_t::size_type zmq::mux_t::get_class (int priority_)
+{
+    //  Find the class. Classes are ordered by descending priority.
+    classes_t::size_type pos = 0;
+    while (pos != classes.size () && classes [pos].priority > priority_)
+        pos ++;
+    if (pos != classes.size () && classes [pos].priority == priority_)
+        return pos;
+
+    //  Create a new class. Classes that follow are shifted, so adjust 'top'.
+    class_t cls;
+    cls.priority = priority_;
+    cls.active = 0;
+    cls.current = 0;
+    cls.skipped = 0;
+    classes.insert (classes.begin () + pos, cls);
+    if (pos < top)
+        top ++;
+    return pos;
+}
+
+void zmq::mux_t::activate (class_t &class_, size_t index_)
+{
+    entry_t &entry = class_.pipes [index_];
+    assert (!entry.active);
+    entry.active = true;
+    if (!class_.active) {
+        entry.prev = index_;
+        entry.next = index_;
+        class_.current = index_;
+    }
+    else {
+        entry.next = class_.current;
+        entry.prev = class_.pipes [class_.current].prev;
+        class_.pipes [entry.prev].next = index_;
+        class_.pipes [entry.next].prev = index_;
+    }
+    class_.active ++;
+    class_.skipped = 0;
+}
+
+void zmq::mux_t::deactivate (class_t &class_, size_t index_)
+{
+    entry_t &entry = class_.pipes [index_];
+    assert (entry.active);
+    entry.active = false;
+    class_.active --;
+    class_.skipped = 0;
+    class_.pipes [entry.prev].next = entry.next;
+    class_.pipes [entry.next].prev = entry.prev;
+    if (class_.current == index_)
+        class_.current = entry.next;
+}
+
+void zmq::mux_t::advance (class_t &class_)
+{
+    class_.current = class_.pipes [class_.current].next;
+}
+
+void zmq::mux_t::charge (entry_t &entry_, raw_message_t *msg_)
+{
+    //  Each message costs at least a single byte, so that pipe passing
+    //  empty messages and notifications can't starve the others.
+    size_t size = raw_message_size (msg_);
+    entry_.deficit -= size ? size : 1;
+}
+
+void zmq::mux_t::skip (class_t &class_, entry_t &entry_)
+{
+    //  The share is replenished by a single quantum per visit. The debt
+    //  of the pipe that passed a large message is carried over.
+    entry_.deficit += entry_.weight;
+    advance (class_);
+
+    //  If all the active pipes were visited without any of them passing
+    //  a message, none of them has any share left. Rather than doing
+    //  empty rounds until the first one has, replenish all of them
+    //  by the number of quanta the first one needs in a single step.
+    class_.skipped ++;
+    if (class_.skipped < class_.active)
+        return;
+    int64_t rounds = 0;
+    size_t index = class_.current;
+    for (size_t i = 0; i != class_.active; i ++) {
+        entry_t &entry = class_.pipes [index];
+        assert (entry.weight);
+        int64_t needed = (entry.weight - entry.deficit) / entry.weight;
+        if (i == 0 || needed < rounds)
+            rounds = needed;
+        index = entry.next;
+    }
+    for (size_t i = 0; i != class_.active; i ++) {
+        entry_t &entry = class_.pipes [index];
+        entry.deficit += rounds * entry.weight;
+        index = entry.next;
+    }
+    class_.skipped = 0;
 }
@@ -19,15 +19,15 @@
 
 #include <zmq/out_engine.hpp>
 
-zmq::out_engine_t *zmq::out_engine_t::create (bool load_balancing_)
+zmq::out_engine_t *zmq::out_engine_t::create (style_t style_)
 {
-    out_engine_t *instance = new out_engine_t (load_balancing_);
+    out_engine_t *instance = new out_engine_t (style_);
     assert (instance);
     return instance;
 }
 
-zmq::out_engine_t::out_engine_t (bool load_balancing_) :
-    engine_base_t <true, false> (load_balancing_)
+zmq::out_engine_t::out_engine_t (style_t style_) :
+    engine_base_t <true, false> (style_)
 {
 }
 
@@ -40,6 +40,11 @@ bool zmq::out_engine_t::write (message_t &msg_)
     return demux->write (msg_);
 }
 
+size_t zmq::out_engine_t::write_many (message_t *msgs_, size_t count_)
+{
+    return demux->write_many (msgs_, count_);
+}
+
 void zmq::out_engine_t::flush ()
 {
     demux->flush ();
@@ -19,6 +19,7 @@
 
 #include <zmq/pipe.hpp>
 #include <zmq/command.hpp>
+#include <zmq/counters.hpp>
 
 zmq::pipe_t::pipe_t (i_thread *source_thread_, i_engine *source_engine_,
       i_thread *destination_thread_, i_engine *destination_engine_) :
@@ -36,7 +37,15 @@ zmq::pipe_t::pipe_t (i_thread *source_thread_, i_engine *source_engine_,
     swapping (false),
     in_swap_msg_cnt (0),
     writer_terminating (false),
-    reader_terminating (false)
+    reader_terminating (false),
+    index (0),
+    priority (0),
+    weight (0),
+    overflow (overflow_block),
+    overflow_timeout (0),
+    full_since (0),
+    conflated (false),
+    dropped (NULL)
 {
     //  Compute watermarks for the pipe. If either of engines has infinite
     //  watermarks (hwm = 0) the pipe watermarks will be infinite as well.
@@ -72,6 +81,10 @@ zmq::pipe_t::~pipe_t ()
     if (data_dam)
         delete data_dam;
 
+    //  Destroy the message waiting to be written to the pipe.
+    if (conflated)
+        raw_message_destroy (&conflated_msg);
+
     //  Destroy the messages in the pipe itself.
     raw_message_t message;
     pipe.flush ();
@@ -87,16 +100,28 @@ bool zmq::pipe_t::check_write ()
 
 void zmq::pipe_t::write (raw_message_t *msg_)
 {
-    //  If we are allowed to write to the pipe, delayed gap notification must
-    //  have been written beforehand.
-    assert (!delayed_gap);
-
-    //  If we have hit the queue limit, switch into swapping mode.
+    //  If we have hit the queue limit, either keep the message aside
+    //  (conflating pipe) or switch into swapping mode.
     if (in_core_msg_cnt == (size_t) hwm && hwm != 0) {
-        assert (data_dam);
+        if (!data_dam) {
+            assert (overflow == overflow_conflate);
+            if (conflated) {
+                raw_message_destroy (&conflated_msg);
+                if (dropped)
+                    (*dropped) ++;
+                counter_add (counter_overflow_drops, 1);
+            }
+            conflated_msg = *msg_;
+            conflated = true;
+            return;
+        }
         swapping = true;
     }
 
+    //  If we are allowed to write to the pipe, delayed gap notification must
+    //  have been written beforehand.
+    assert (!delayed_gap);
+
     //  Write the message into main memory or swap file.
     if (swapping) {
         bool rc = data_dam->store (msg_);
@@ -121,6 +146,21 @@ void zmq::pipe_t::gap ()
     flush ();
 }
 
+void zmq::pipe_t::drop ()
+{
+    if (dropped)
+        (*dropped) ++;
+    counter_add (counter_overflow_drops, 1);
+    gap ();
+}
+
+bool zmq::pipe_t::overflow_expired (uint64_t now_)
+{
+    if (!full_since)
+        full_since = now_;
+    return now_ - full_since >= overflow_timeout;
+}
+
 void zmq::pipe_t::revive ()
 {
     assert (!alive);
@@ -133,17 +173,36 @@ void zmq::pipe_t::set_head (uint64_t position_)
     in_core_msg_cnt -= position_ - last_head_position;
     last_head_position = position_;
 
+    //  Once the delimiter was written, nothing may follow it.
+    if (writer_terminating)
+        return;
+
     //  Transfer messages from the data dam into the main memory.
     if (swapping && in_core_msg_cnt < (size_t) lwm)
         swap_in ();
 
-    //  If there's a gap notification waiting, push it into the queue.
+    //  If there's a gap notification or a conflated message waiting, push
+    //  it into the queue. The writer may be idle at the moment, so flush
+    //  the pipe straight away.
+    bool written = false;
     if (delayed_gap && check_write ()) {
         raw_message_t msg;
         raw_message_init_notification (&msg, raw_message_t::gap_tag);
-        write (&msg);
         delayed_gap = false;
+        write (&msg);
+        written = true;
+    }
+    if (conflated && check_write ()) {
+        conflated = false;
+        write (&conflated_msg);
+        written = true;
     }
+    if (written)
+        flush ();
+
+    //  The pipe is not full any more.
+    if (full_since && check_write ())
+        full_since = 0;
 }
 
 void zmq::pipe_t::flush ()
@@ -196,10 +255,61 @@ bool zmq::pipe_t::read (raw_message_t *msg_)
     return true;
 }
 
+size_t zmq::pipe_t::read_batch (raw_message_t *msgs_, size_t max_)
+{
+    //  If the pipe is dead, there's nothing we can do.
+    if (!alive)
+        return 0;
+
+    //  Get all the prefetched messages, if there are none, die.
+    size_t count = pipe.read_batch (msgs_, max_);
+    if (!count) {
+        alive = false;
+        return 0;
+    }
+
+    //  Nothing is ever written after the delimiter, so if it was read it is
+    //  the last message in the batch. Start the shutdown process and don't
+    //  pass the delimiter to the caller.
+    if (msgs_ [count - 1].content ==
+          (message_content_t*) raw_message_t::delimiter_tag) {
+        terminate_reader ();
+        count --;
+    }
+
+    //  Report the head position to the writer thread if the batch has
+    //  crossed the reporting period boundary (see 'read' for details).
+    if (hwm && count) {
+        uint64_t period = hwm - lwm + 1;
+        uint64_t old_head = head;
+        head += count;
+        if (head / period != old_head / period) {
+            command_t cmd;
+            cmd.init_engine_head (source_engine, this, head);
+            destination_thread->send_command (source_thread, cmd);
+        }
+    }
+
+    return count;
+}
+
 void zmq::pipe_t::terminate_writer ()
 {
     if (!writer_terminating) {
 
+        //  Pass the delayed gap notification and the conflated message
+        //  to the reader before the delimiter.
+        if (delayed_gap) {
+            raw_message_t msg;
+            raw_message_init_notification (&msg, raw_message_t::gap_tag);
+            pipe.write (msg);
+            delayed_gap = false;
+        }
+        if (conflated) {
+            pipe.write (conflated_msg);
+            conflated = false;
+        }
+
         //  Push the delimiter to the pipe. Delimiter is a message for pipe
         //  reader that there will be no more messages in the pipe.
         raw_message_t delimiter;
@@ -248,6 +358,37 @@ void zmq::pipe_t::reader_terminated ()
     destination_engine = NULL;
 }
 
+bool zmq::pipe_t::is_terminating (i_engine *engine_)
+{
+    if (source_engine == engine_)
+        return writer_terminating;
+    assert (destination_engine == engine_);
+    return reader_terminating;
+}
+
+zmq::i_thread *zmq::pipe_t::get_peer_thread (i_engine *engine_)
+{
+    if (source_engine == engine_)
+        return destination_thread;
+    assert (destination_engine == engine_);
+    return source_thread;
+}
+
+zmq::i_thread *zmq::pipe_t::rehome (i_engine *engine_, i_thread *thread_)
+{
+    i_thread *old_thread;
+    if (source_engine == engine_) {
+        old_thread = source_thread;
+        source_thread = thread_;
+    }
+    else {
+        assert (destination_engine == engine_);
+        old_thread = destination_thread;
+        destination_thread = thread_;
+    }
+    return old_thread;
+}
+
 void zmq::pipe_t::swap_in ()
 {
     while (in_swap_msg_cnt > 0 && in_core_msg_cnt < (size_t) hwm) {
@@ -96,24 +96,28 @@ void zmq::poll_t::reset_pollout (handle_t handle_)
     pollset [index].events &= ~((short) POLLOUT);
 }
 
-bool zmq::poll_t::process_events (poller_t <poll_t> *poller_, bool timers_)
+void zmq::poll_t::set_edge_triggered (handle_t)
+{
+    //  Edge-triggered notifications are not supported by poll.
+}
+
+bool zmq::poll_t::process_events (poller_t <poll_t> *poller_,
+    int timeout_)
 {
     //  Wait for events.
     int rc;
     while (true) {
         rc = poll (&pollset [0], pollset.size (),
-            timers_ ? max_timer_period : -1);
+            timeout_);
         if (!(rc == -1 && errno == EINTR)) {
             errno_assert (rc != -1);
             break;
         }
     }
 
-    //  Handle timer.
-    if (!rc) {
-        poller_->timer_event ();
+    //  Timeout expired. Timers are handled by the poller.
+    if (!rc)
         return false;
-    }
 
     for (pollset_t::size_type i = 0; i < pollset.size (); i ++) {
         assert (!(pollset [i].revents & POLLNVAL));
@@ -20,8 +20,10 @@
 #include <assert.h>
 #include <algorithm>
 #include <zmq/publisher.hpp>
+#include <zmq/clock.hpp>
 
-zmq::publisher_t::publisher_t ()
+zmq::publisher_t::publisher_t () :
+    filtered (0)
 {
 }
 
@@ -33,6 +35,16 @@ void zmq::publisher_t::send_to (pipe_t *pipe_)
 {
     //  Associate demux with a new pipe.
     pipes.push_back (pipe_);
+
+    const pipe_t::topics_t &pipe_topics = pipe_->get_topics ();
+    if (pipe_topics.empty ()) {
+        unfiltered.push_back (pipe_);
+        return;
+    }
+    for (pipe_t::topics_t::const_iterator it = pipe_topics.begin ();
+          it != pipe_topics.end (); it ++)
+        topics.add (*it, pipe_);
+    filtered ++;
 }
 
 bool zmq::publisher_t::write (message_t &msg_)
@@ -52,7 +64,38 @@ bool zmq::publisher_t::write (message_t &msg_)
         return true;
     }
 
-    int pipes_count = pipes.size ();
+    //  If there are pipes with topics, find out which pipes the message
+    //  should be sent to. A pipe subscribed to several matching topics
+    //  has to get the message once only.
+    pipes_t *dests = &pipes;
+    if (filtered) {
+        targets.assign (unfiltered.begin (), unfiltered.end ());
+        size_t matched = targets.size ();
+        topics.match ((const unsigned char*) msg_.data (), msg_.size (),
+            targets);
+        if (targets.size () - matched > 1) {
+            std::sort (targets.begin () + matched, targets.end ());
+            targets.erase (std::unique (targets.begin () + matched,
+                targets.end ()), targets.end ());
+        }
+        dests = &targets;
+    }
+
+    //  First check whether all pipes are available for writing. A full pipe
+    //  stalls the publisher only if its overflow policy is blocking.
+    bool overflowed = false;
+    for (pipes_t::iterator it = dests->begin (); it != dests->end (); it ++)
+        if (!(*it)->check_write ()) {
+            if ((*it)->get_overflow () == pipe_t::overflow_block)
+                return false;
+            overflowed = true;
+        }
+
+    //  Apply overflow policies of the full pipes.
+    if (overflowed)
+        dests = overflow (dests);
+
+    int pipes_count = dests->size ();
 
     //  If there are no pipes available, simply drop the message.
     if (pipes_count == 0) {
@@ -61,14 +104,10 @@ bool zmq::publisher_t::write (message_t &msg_)
         return true;
     }
 
-    //  First check whether all pipes are available for writing.
-    for (pipes_t::iterator it = pipes.begin (); it != pipes.end (); it ++)
-        if (!(*it)->check_write ())
-            return false;
-
     //  For VSMs the copying is straighforward.
     if (msg->content == (message_content_t*) raw_message_t::vsm_tag) {
-        for (pipes_t::iterator it = pipes.begin (); it != pipes.end (); it ++)
+        for (pipes_t::iterator it = dests->begin (); it != dests->end ();
+              it ++)
             (*it)->write (msg);
         raw_message_init (msg, 0);
         return true;
@@ -78,7 +117,7 @@ bool zmq::publisher_t::write (message_t &msg_)
     //  to send the message to - no refcount adjustment (i.e. atomic
     //  operations) needed.
     if (pipes_count == 1) {
-        (*pipes.begin ())->write (msg);
+        (*dests->begin ())->write (msg);
         raw_message_init (msg, 0);
         return true;
     }
@@ -94,7 +133,7 @@ bool zmq::publisher_t::write (message_t &msg_)
     }
 
     //  Push the message to all destinations.
-    for (pipes_t::iterator it = pipes.begin (); it != pipes.end (); it ++)
+    for (pipes_t::iterator it = dests->begin (); it != dests->end (); it ++)
         (*it)->write (msg);
 
     //  Detach the original message from the data buffer.
@@ -103,6 +142,52 @@ bool zmq::publisher_t::write (message_t &msg_)
     return true;
 }
 
+zmq::publisher_t::pipes_t *zmq::publisher_t::overflow (pipes_t *dests_)
+{
+    //  Conflating pipes accept the message even if they are full. Other
+    //  full pipes miss it, unless they've been full for too long, in which
+    //  case they are closed.
+    ready.clear ();
+    uint64_t now = 0;
+    for (pipes_t::iterator it = dests_->begin (); it != dests_->end ();
+          it ++) {
+        pipe_t *pipe = *it;
+        if (pipe->check_write () ||
+              pipe->get_overflow () == pipe_t::overflow_conflate) {
+            ready.push_back (pipe);
+            continue;
+        }
+        if (pipe->get_overflow () == pipe_t::overflow_disconnect) {
+            if (!now)
+                now = clock_ms ();
+            if (pipe->overflow_expired (now)) {
+                expired.push_back (pipe);
+                continue;
+            }
+        }
+        pipe->drop ();
+    }
+
+    //  'dests_' may be the list of all the pipes, so close the expired pipes
+    //  only after it was traversed. The pipe will be released once more when
+    //  the reader confirms the shutdown, that's a no-op.
+    for (pipes_t::iterator it = expired.begin (); it != expired.end (); it ++) {
+        release_pipe (*it);
+        (*it)->terminate_writer ();
+    }
+    expired.clear ();
+
+    return &ready;
+}
+
+size_t zmq::publisher_t::write_many (message_t *msgs_, size_t count_)
+{
+    size_t sent = 0;
+    while (sent != count_ && write (msgs_ [sent]))
+        sent ++;
+    return sent;
+}
+
 void zmq::publisher_t::flush ()
 {
     //  Flush all the present messages to the pipes.
@@ -121,14 +206,25 @@ bool zmq::publisher_t::empty ()
     return pipes.empty ();
 }
 
+void zmq::publisher_t::get_pipes (std::vector <pipe_t*> &pipes_)
+{
+    pipes_.insert (pipes_.end (), pipes.begin (), pipes.end ());
+}
+
 void zmq::publisher_t::release_pipe (pipe_t *pipe_)
 {
-    for (pipes_t::iterator it = pipes.begin (); it != pipes.end (); it ++) {
-        if (*it == pipe_) {
-            pipes.erase (it);
-            return;
-        }
+    pipes_t::iterator it = std::find (pipes.begin (), pipes.end (), pipe_);
+    if (it == pipes.end ())
+        return;
+    pipes.erase (it);
+
+    if (pipe_->get_topics ().empty ()) {
+        unfiltered.erase (std::find (unfiltered.begin (), unfiltered.end (),
+            pipe_));
+        return;
     }
+    topics.remove (pipe_);
+    filtered --;
 }
 
 void zmq::publisher_t::initialise_shutdown ()
@@ -191,6 +191,12 @@ void zmq::sctp_engine_t::unregister_event ()
     //  TODO: Implement this. For now we'll do nothing here.
 }
 
+bool zmq::sctp_engine_t::detach_event ()
+{
+    //  Moving the engine to a different I/O thread is not supported.
+    return false;
+}
+
 void zmq::sctp_engine_t::revive (pipe_t *pipe_)
 {
     if (!shutting_down) {
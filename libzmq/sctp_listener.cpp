@@ -210,6 +210,12 @@ void zmq::sctp_listener_t::unregister_event ()
     //  TODO: Implement this. For now we'll do nothing here.
 }
 
+bool zmq::sctp_listener_t::detach_event ()
+{
+    //  Moving the engine to a different I/O thread is not supported.
+    return false;
+}
+
 const char *zmq::sctp_listener_t::get_arguments ()
 {
     return arguments;
@@ -120,7 +120,13 @@ void zmq::select_t::reset_pollout (handle_t handle_)
     FD_CLR (handle_.fd, &source_set_out);
 }
 
-bool zmq::select_t::process_events (poller_t <select_t> *poller_, bool timers_)
+void zmq::select_t::set_edge_triggered (handle_t)
+{
+    //  Edge-triggered notifications are not supported by select.
+}
+
+bool zmq::select_t::process_events (poller_t <select_t> *poller_,
+    int timeout_)
 {
     //  Intialise the pollsets.
     memcpy (&readfds, &source_set_in, sizeof source_set_in);
@@ -132,14 +138,13 @@ bool zmq::select_t::process_events (poller_t <select_t> *poller_, bool timers_)
 
         //  Compute the timout interval. Select is free to overwrite the
         //  value so have to compute it each time anew.
-        timeval timeout = {max_timer_period / 1000,
-            (max_timer_period % 1000) * 1000};
+        timeval timeout = {timeout_ / 1000, (timeout_ % 1000) * 1000};
 
         //  Wait for events.
         int rc;
         while (true) {
             rc = select (maxfd + 1, &readfds, &writefds, &exceptfds,
-                timers_ ? &timeout : NULL);
+                timeout_ >= 0 ? &timeout : NULL);
 
 #ifdef ZMQ_HAVE_WINDOWS
             wsa_assert (rc != SOCKET_ERROR);
@@ -152,11 +157,9 @@ bool zmq::select_t::process_events (poller_t <select_t> *poller_, bool timers_)
 #endif
         }
 
-        //  Handle timer.
-        if (timers_ && !rc) {
-            poller_->timer_event ();
+        //  Timeout expired. Timers are handled by the poller.
+        if (timeout_ >= 0 && !rc)
             return false;
-        }
 
         //  TODO: Select sometimes returns 0 even though no event have occured
         //  and no timeout was set. Document this situation in detail...
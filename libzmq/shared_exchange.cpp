@@ -0,0 +1,108 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <zmq/shared_exchange.hpp>
+
+zmq::shared_exchange_t::shared_exchange_t (out_engine_t *engine_,
+      i_signaler *signaler_, int signal_) :
+    engine (engine_),
+    signaler (signaler_),
+    signal (signal_),
+    pending (NULL)
+{
+}
+
+zmq::shared_exchange_t::~shared_exchange_t ()
+{
+    //  Deallocate the messages that haven't been forwarded.
+    node_t *list [2] = {pending, sent.xchg (NULL)};
+    for (int i = 0; i != 2; i ++)
+        while (list [i]) {
+            node_t *node = list [i];
+            list [i] = node->next;
+            raw_message_destroy (&node->msg);
+            delete node;
+        }
+}
+
+void zmq::shared_exchange_t::send (message_t &message_)
+{
+    //  Move the message content to a new list node.
+    raw_message_t *msg = (raw_message_t*) &message_;
+    node_t *node = new node_t;
+    assert (node);
+    node->msg = *msg;
+    raw_message_init (msg, 0);
+
+    //  Push the node to the list.
+    node_t *head = NULL;
+    while (true) {
+        node->next = head;
+        node_t *old = sent.cas (head, node);
+        if (old == head)
+            break;
+        head = old;
+    }
+
+    //  If the list was empty, the owner thread may not know about the
+    //  message yet. Otherwise it was already signaled by the thread that
+    //  sent the first message on the list.
+    if (!head)
+        signaler->signal (signal);
+}
+
+void zmq::shared_exchange_t::forward ()
+{
+    bool written = false;
+    while (true) {
+
+        //  If all the taken over messages were written, take over the
+        //  messages sent since.
+        if (!pending) {
+            pending = reverse (sent.xchg (NULL));
+            if (!pending)
+                break;
+        }
+
+        //  Stop on pipe limits. Message will be retried later on.
+        if (!engine->write (*(message_t*) &pending->msg))
+            break;
+        written = true;
+
+        node_t *node = pending;
+        pending = node->next;
+        delete node;
+    }
+
+    if (written)
+        engine->flush ();
+}
+
+zmq::shared_exchange_t::node_t *zmq::shared_exchange_t::reverse (
+    node_t *list_)
+{
+    node_t *result = NULL;
+    while (list_) {
+        node_t *node = list_;
+        list_ = node->next;
+        node->next = result;
+        result = node;
+    }
+    return result;
+}
@@ -33,6 +33,7 @@
 #include <netinet/in.h>
 #include <netdb.h>
 #include <fcntl.h>
+#include <sys/uio.h>
 #endif
 
 #ifdef ZMQ_HAVE_OPENVMS
@@ -41,6 +42,7 @@
 
 #include <zmq/err.hpp>
 #include <zmq/ip.hpp>
+#include <zmq/config.hpp>
 
 #ifdef ZMQ_HAVE_WINDOWS
 
@@ -144,6 +146,32 @@ int zmq::tcp_socket_t::write (const void *data, int size)
     return (size_t) nbytes;
 }
 
+int zmq::tcp_socket_t::writev (const io_vector_t *iov, int count)
+{
+    assert (count <= max_io_vectors);
+    WSABUF buffers [max_io_vectors];
+    for (int i = 0; i != count; i ++) {
+        buffers [i].buf = (char*) iov [i].data;
+        buffers [i].len = (u_long) iov [i].size;
+    }
+
+    DWORD nbytes;
+    int rc = WSASend (s, buffers, count, &nbytes, 0, NULL, NULL);
+
+    //  If not a single byte can be written to the socket in non-blocking mode
+    //  we'll get an error (this may happen during the speculative write).
+    if (rc == SOCKET_ERROR && WSAGetLastError () == WSAEWOULDBLOCK)
+        return 0;
+
+    //  Signalise peer failure.
+    if (rc == SOCKET_ERROR && WSAGetLastError () == WSAECONNRESET)
+        return -1;
+
+    wsa_assert (rc != SOCKET_ERROR);
+
+    return (int) nbytes;
+}
+
 int zmq::tcp_socket_t::read (void *data, int size)
 {
     int nbytes = recv (s, (char*) data, size, 0);
@@ -307,6 +335,30 @@ int zmq::tcp_socket_t::write (const void *data, int size)
     return (size_t) nbytes;
 }
 
+int zmq::tcp_socket_t::writev (const io_vector_t *iov, int count)
+{
+    assert (count <= max_io_vectors);
+    iovec buffers [max_io_vectors];
+    for (int i = 0; i != count; i ++) {
+        buffers [i].iov_base = iov [i].data;
+        buffers [i].iov_len = iov [i].size;
+    }
+
+    ssize_t nbytes = ::writev (s, buffers, count);
+
+    //  If not a single byte can be written to the socket in non-blocking mode
+    //  we'll get an error (this may happen during the speculative write).
+    if (nbytes == -1 && (errno == EAGAIN || errno == EINTR))
+        return 0;
+
+    //  Signalise peer failure.
+    if (nbytes == -1 && (errno == ECONNRESET || errno == EPIPE))
+        return -1;
+
+    errno_assert (nbytes != -1);
+    return (int) nbytes;
+}
+
 int zmq::tcp_socket_t::read (void *data, int size)
 {
     ssize_t nbytes = recv (s, data, size, block ? MSG_WAITALL : 0);
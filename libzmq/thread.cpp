@@ -21,12 +21,17 @@
 #include <zmq/err.hpp>
 #include <zmq/platform.hpp>
 
+#if defined ZMQ_HAVE_LINUX
+#include <sched.h>
+#endif
+
 #ifdef ZMQ_HAVE_WINDOWS
 
-void zmq::thread_t::start (thread_fn *tfn_, void *arg_)
+void zmq::thread_t::start (thread_fn *tfn_, void *arg_, uint64_t affinity_)
 {
     tfn = tfn_;
     arg =arg_;
+    affinity = affinity_;
     descriptor = (HANDLE) _beginthreadex (NULL, 0,
         &zmq::thread_t::thread_routine, this, 0 , NULL);
     win_assert (descriptor != NULL);    
@@ -38,19 +43,31 @@ void zmq::thread_t::stop ()
     win_assert (rc != WAIT_FAILED);
 }
 
+void zmq::thread_t::set_affinity (uint64_t affinity_)
+{
+    if (!affinity_)
+        return;
+
+    DWORD_PTR rc = SetThreadAffinityMask (GetCurrentThread (),
+        (DWORD_PTR) affinity_);
+    win_assert (rc != 0);
+}
+
 unsigned int __stdcall zmq::thread_t::thread_routine (void *arg_)
 {
     thread_t *self = (thread_t*) arg_;
+    set_affinity (self->affinity);
     self->tfn (self->arg);
     return 0;
 }
 
 #else
 
-void zmq::thread_t::start (thread_fn *tfn_, void *arg_)
+void zmq::thread_t::start (thread_fn *tfn_, void *arg_, uint64_t affinity_)
 {
     tfn = tfn_;
     arg =arg_;
+    affinity = affinity_;
     int rc = pthread_create (&descriptor, NULL, thread_routine, this);
     errno_assert (rc == 0);
 }
@@ -61,9 +78,26 @@ void zmq::thread_t::stop ()
     errno_assert (rc == 0);
 }
 
+void zmq::thread_t::set_affinity (uint64_t affinity_)
+{
+    if (!affinity_)
+        return;
+
+#if defined ZMQ_HAVE_LINUX
+    cpu_set_t cpus;
+    CPU_ZERO (&cpus);
+    for (int cpu = 0; cpu != 64; cpu ++)
+        if (affinity_ & ((uint64_t) 1 << cpu))
+            CPU_SET (cpu, &cpus);
+    int rc = pthread_setaffinity_np (pthread_self (), sizeof (cpus), &cpus);
+    errno_assert (rc == 0);
+#endif
+}
+
 void *zmq::thread_t::thread_routine (void *arg_)
 {
     thread_t *self = (thread_t*) arg_;   
+    set_affinity (self->affinity);
     self->tfn (self->arg);
     return NULL;
 }
@@ -0,0 +1,240 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <limits.h>
+
+#include <zmq/timer_wheel.hpp>
+#include <zmq/err.hpp>
+
+zmq::timer_wheel_t::timer_wheel_t () :
+    current (0),
+    count (0),
+    free_nodes (NULL)
+{
+    for (int level = 0; level != levels; level ++) {
+        for (int slot = 0; slot != slots; slot ++) {
+            node_t *sentinel = &wheel [level][slot];
+            sentinel->prev = sentinel;
+            sentinel->next = sentinel;
+            sentinel->slot = sentinel;
+        }
+        bitmaps [level] = 0;
+    }
+}
+
+zmq::timer_wheel_t::~timer_wheel_t ()
+{
+    for (int level = 0; level != levels; level ++)
+        for (int slot = 0; slot != slots; slot ++) {
+            node_t *sentinel = &wheel [level][slot];
+            while (sentinel->next != sentinel) {
+                node_t *node = sentinel->next;
+                sentinel->next = node->next;
+                delete node;
+            }
+        }
+
+    while (free_nodes) {
+        node_t *node = free_nodes;
+        free_nodes = node->next;
+        delete node;
+    }
+}
+
+void *zmq::timer_wheel_t::add (i_pollable *engine_, uint64_t now_,
+    int timeout_)
+{
+    assert (timeout_ >= 0);
+
+    //  If there are no timers, there's nothing to process till now.
+    if (!count && now_ > current)
+        current = now_;
+
+    node_t *node = free_nodes;
+    if (node)
+        free_nodes = node->next;
+    else {
+        node = new node_t;
+        assert (node);
+    }
+
+    //  Timers for the tick being processed would get into a slot that was
+    //  already processed. Postpone them till the next tick.
+    node->engine = engine_;
+    node->deadline = now_ + timeout_;
+    if (node->deadline <= current)
+        node->deadline = current + 1;
+
+    insert (node);
+    count ++;
+    return node;
+}
+
+void zmq::timer_wheel_t::cancel (void *timer_)
+{
+    node_t *node = (node_t*) timer_;
+    unlink (node);
+    count --;
+    node->next = free_nodes;
+    free_nodes = node;
+}
+
+int zmq::timer_wheel_t::timeout (uint64_t now_)
+{
+    if (!count)
+        return -1;
+
+    uint64_t tick = next_tick ();
+    if (tick <= now_)
+        return 0;
+    if (tick - now_ > INT_MAX)
+        return INT_MAX;
+    return (int) (tick - now_);
+}
+
+void zmq::timer_wheel_t::execute (uint64_t now_)
+{
+    while (count && current < now_) {
+
+        //  Skip the ticks where there's nothing to do.
+        uint64_t tick = next_tick ();
+        if (tick > now_)
+            break;
+        current = tick;
+
+        //  Move the timers from the higher levels to the lower ones if
+        //  the tick is at the beginning of the block they belong to.
+        for (int level = 1; level != levels; level ++) {
+            if (current & (((uint64_t) 1 << (slot_bits * level)) - 1))
+                break;
+            cascade (level, (int) (current >> (slot_bits * level)) &
+                slot_mask);
+        }
+
+        //  Fire the timers. The slot is re-checked after each timer as
+        //  the engine may cancel other timers.
+        node_t *sentinel = &wheel [0][current & slot_mask];
+        while (sentinel->next != sentinel) {
+            node_t *node = sentinel->next;
+            i_pollable *engine = node->engine;
+            cancel (node);
+            engine->timer_event ();
+        }
+    }
+
+    if (now_ > current)
+        current = now_;
+}
+
+void zmq::timer_wheel_t::insert (node_t *node_)
+{
+    uint64_t deadline = node_->deadline;
+    if (deadline < current)
+        deadline = current;
+    uint64_t delta = deadline - current;
+
+    //  Find the lowest level that covers the deadline. Timers beyond
+    //  the range of the wheel are parked in the top level slot that is
+    //  going to be cascaded last and are redistributed from there.
+    int level = 0;
+    while (level != levels - 1 && delta >> (slot_bits * (level + 1)))
+        level ++;
+    int slot;
+    if (delta >> (slot_bits * levels))
+        slot = (int) (current >> (slot_bits * level)) & slot_mask;
+    else
+        slot = (int) (deadline >> (slot_bits * level)) & slot_mask;
+
+    node_t *sentinel = &wheel [level][slot];
+    node_->slot = sentinel;
+    node_->next = sentinel;
+    node_->prev = sentinel->prev;
+    sentinel->prev->next = node_;
+    sentinel->prev = node_;
+    bitmaps [level] |= (uint64_t) 1 << slot;
+}
+
+void zmq::timer_wheel_t::unlink (node_t *node_)
+{
+    node_->prev->next = node_->next;
+    node_->next->prev = node_->prev;
+
+    //  If the slot became empty, mark it in the bitmap.
+    node_t *sentinel = node_->slot;
+    if (sentinel->next == sentinel) {
+        int index = (int) (sentinel - &wheel [0][0]);
+        bitmaps [index / slots] &= ~((uint64_t) 1 << (index % slots));
+    }
+}
+
+void zmq::timer_wheel_t::cascade (int level_, int slot_)
+{
+    node_t *sentinel = &wheel [level_][slot_];
+    if (sentinel->next == sentinel)
+        return;
+
+    //  Detach the list from the slot first. Parked timers may be inserted
+    //  into the same slot anew.
+    node_t *node = sentinel->next;
+    sentinel->prev->next = NULL;
+    sentinel->prev = sentinel;
+    sentinel->next = sentinel;
+    bitmaps [level_] &= ~((uint64_t) 1 << slot_);
+
+    while (node) {
+        node_t *next = node->next;
+        insert (node);
+        node = next;
+    }
+}
+
+uint64_t zmq::timer_wheel_t::next_tick ()
+{
+    //  On each level, find the first non-empty slot following the current
+    //  one. Level 0 slots expire at their tick, slots on higher levels are
+    //  cascaded at the beginning of their block.
+    uint64_t tick = (uint64_t) -1;
+    for (int level = 0; level != levels; level ++) {
+        if (!bitmaps [level])
+            continue;
+        int shift = slot_bits * level;
+        uint64_t block = (current >> shift) + 1;
+        block += distance (bitmaps [level], (int) block & slot_mask);
+        if ((block << shift) < tick)
+            tick = block << shift;
+    }
+    assert (tick != (uint64_t) -1);
+    return tick;
+}
+
+int zmq::timer_wheel_t::distance (uint64_t bitmap_, int from_)
+{
+    uint64_t rotated = from_ ?
+        (bitmap_ >> from_) | (bitmap_ << (slots - from_)) : bitmap_;
+#if defined __GNUC__
+    return __builtin_ctzll (rotated);
+#else
+    int pos = 0;
+    while (!(rotated & 1)) {
+        rotated >>= 1;
+        pos ++;
+    }
+    return pos;
+#endif
+}
@@ -0,0 +1,168 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+
+#include <zmq/topic_trie.hpp>
+
+zmq::topic_trie_t::topic_trie_t ()
+{
+}
+
+zmq::topic_trie_t::~topic_trie_t ()
+{
+    for (node_t::children_t::iterator it = root.children.begin ();
+          it != root.children.end (); it ++)
+        destroy (*it);
+}
+
+void zmq::topic_trie_t::add (const std::string &topic_, pipe_t *pipe_)
+{
+    node_t *node = &root;
+    size_t pos = 0;
+    while (pos != topic_.size ()) {
+
+        //  If there's no child to follow, the rest of the topic becomes
+        //  the label of a new leaf node.
+        unsigned char c = topic_ [pos];
+        node_t::children_t::iterator it = find_child (node, c);
+        if (it == node->children.end () ||
+              (unsigned char) (*it)->label [0] != c) {
+            node_t *leaf = new node_t;
+            assert (leaf);
+            leaf->label = topic_.substr (pos);
+            node->children.insert (it, leaf);
+            node = leaf;
+            break;
+        }
+
+        //  Find how much of the child's label matches the topic.
+        node_t *child = *it;
+        size_t common = 1;
+        while (common != child->label.size () &&
+              pos + common != topic_.size () &&
+              child->label [common] == topic_ [pos + common])
+            common ++;
+
+        //  If the topic diverges from the label (or ends) in the middle
+        //  of the label, split the child in two.
+        if (common != child->label.size ()) {
+            node_t *split = new node_t;
+            assert (split);
+            split->label = child->label.substr (0, common);
+            child->label.erase (0, common);
+            split->children.push_back (child);
+            *it = split;
+            child = split;
+        }
+
+        node = child;
+        pos += common;
+    }
+
+    if (std::find (node->pipes.begin (), node->pipes.end (), pipe_) ==
+          node->pipes.end ())
+        node->pipes.push_back (pipe_);
+}
+
+void zmq::topic_trie_t::remove (pipe_t *pipe_)
+{
+    remove (&root, pipe_);
+}
+
+void zmq::topic_trie_t::match (const unsigned char *data_, size_t size_,
+    std::vector <pipe_t*> &pipes_)
+{
+    node_t *node = &root;
+    size_t pos = 0;
+    while (true) {
+        pipes_.insert (pipes_.end (), node->pipes.begin (), node->pipes.end ());
+        if (pos == size_)
+            return;
+
+        node_t::children_t::iterator it = find_child (node, data_ [pos]);
+        if (it == node->children.end ())
+            return;
+        const std::string &label = (*it)->label;
+        if (label.size () > size_ - pos ||
+              memcmp (label.data (), data_ + pos, label.size ()) != 0)
+            return;
+
+        node = *it;
+        pos += label.size ();
+    }
+}
+
+zmq::topic_trie_t::node_t::children_t::iterator
+    zmq::topic_trie_t::find_child (node_t *node_, unsigned char c_)
+{
+    //  Binary search for the first child whose label doesn't begin with
+    //  a byte lower than 'c_'.
+    node_t::children_t &children = node_->children;
+    size_t low = 0;
+    size_t high = children.size ();
+    while (low != high) {
+        size_t mid = (low + high) / 2;
+        if ((unsigned char) children [mid]->label [0] < c_)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return children.begin () + low;
+}
+
+bool zmq::topic_trie_t::remove (node_t *node_, pipe_t *pipe_)
+{
+    node_->pipes.erase (std::remove (node_->pipes.begin (),
+        node_->pipes.end (), pipe_), node_->pipes.end ());
+
+    node_t::children_t::iterator it = node_->children.begin ();
+    while (it != node_->children.end ()) {
+        node_t *child = *it;
+        if (!remove (child, pipe_)) {
+            it ++;
+            continue;
+        }
+
+        //  Child with no pipes and no children is dropped. Child with no
+        //  pipes and a single child of its own is merged with it.
+        if (child->children.empty ()) {
+            it = node_->children.erase (it);
+        }
+        else {
+            node_t *grandchild = child->children [0];
+            grandchild->label.insert (0, child->label);
+            *it = grandchild;
+            it ++;
+        }
+        delete child;
+    }
+
+    return node_->pipes.empty () && node_->children.size () <= 1;
+}
+
+void zmq::topic_trie_t::destroy (node_t *node_)
+{
+    for (node_t::children_t::iterator it = node_->children.begin ();
+          it != node_->children.end (); it ++)
+        destroy (*it);
+    delete node_;
+}
@@ -21,7 +21,6 @@
 
 void zmq::ypollset_t::signal (int signal_)
 {
-    assert (signal_ >= 0 && signal_ < wait_signal);
-    if (bits.btsr (signal_, wait_signal))
+    if (set.set (signal_))
         sem.signal (0); 
 }
@@ -19,8 +19,32 @@
 
 #include <zmq/ysemaphore.hpp>
 #include <zmq/platform.hpp>
+#include <zmq/counters.hpp>
 
-#if (defined ZMQ_HAVE_LINUX || defined ZMQ_HAVE_OSX || defined ZMQ_HAVE_OPENVMS)
+#if defined ZMQ_HAVE_LINUX && defined __GNUC__
+
+void zmq::ysemaphore_t::signal (int signal_)
+{
+    assert (signal_ == 0);
+
+    //  Post the semaphore. Wake the waiting thread up only if it is asleep.
+    int old = state;
+    while (true) {
+        int prev = __sync_val_compare_and_swap (&state, old, posted);
+        if (prev == old)
+            break;
+        old = prev;
+    }
+    if (old == sleeping) {
+        counter_add (counter_signaler_wakeups, 1);
+        int rc = syscall (SYS_futex, &state, FUTEX_WAKE_PRIVATE, 1,
+            NULL, NULL, 0);
+        errno_assert (rc != -1);
+    }
+}
+
+#elif (defined ZMQ_HAVE_LINUX || defined ZMQ_HAVE_OSX ||\
+    defined ZMQ_HAVE_OPENVMS)
 
 void zmq::ysemaphore_t::signal (int signal_)
 {
@@ -20,6 +20,7 @@
 #include <zmq/platform.hpp>
 #include <zmq/ysocketpair.hpp>
 #include <zmq/fd.hpp>
+#include <zmq/counters.hpp>
 
 #if defined (ZMQ_HAVE_OPENVMS)
 #include <netinet/tcp.h>
@@ -50,21 +51,21 @@ zmq::ysocketpair_t::~ysocketpair_t ()
 
 void zmq::ysocketpair_t::signal (int signal_)
 {
-    assert (signal_ >= 0 && signal_ < 64);
-    integer_t inc = 1;
-    inc <<= signal_;
-    ssize_t sz = write (fd, &inc, sizeof (integer_t));
-    errno_assert (sz == sizeof (integer_t));
+    if (!set.set (signal_))
+        return;
+    counter_add (counter_signaler_wakeups, 1);
+    uint64_t inc = 1;
+    ssize_t sz = write (fd, &inc, sizeof (uint64_t));
+    errno_assert (sz == sizeof (uint64_t));
 }
 
-zmq::ysocketpair_t::integer_t zmq::ysocketpair_t::check ()
+void zmq::ysocketpair_t::reset ()
 {
-    integer_t val;
-    ssize_t sz = read (fd, &val, sizeof (integer_t));
+    uint64_t val;
+    ssize_t sz = read (fd, &val, sizeof (uint64_t));
     if (sz == -1 && errno == EAGAIN)
-        return 0;
+        return;
     errno_assert (sz != -1);
-    return val;
 }
 
 zmq::fd_t zmq::ysocketpair_t::get_fd ()
@@ -127,24 +128,19 @@ zmq::ysocketpair_t::~ysocketpair_t ()
 
 void zmq::ysocketpair_t::signal (int signal_)
 {
-    assert (signal_ >= 0 && signal_ < 64);
-    char c = (char) signal_;
+    if (!set.set (signal_))
+        return;
+    counter_add (counter_signaler_wakeups, 1);
+    char c = 0;
     int rc = send (w, &c, 1, 0);
     win_assert (rc != SOCKET_ERROR);
 }
 
-zmq::ysocketpair_t::integer_t zmq::ysocketpair_t::check ()
+void zmq::ysocketpair_t::reset ()
 {
     char buffer [32]; 
     int nbytes = recv (r, buffer, 32, 0);
     win_assert (nbytes != -1);
-
-    integer_t signals = 0;
-    for (int pos = 0; pos != nbytes; pos++) {
-        assert (buffer [pos] < 64);
-        signals |= (integer_t (1) << (buffer [pos]));
-    }
-    return signals;
 }
 
 zmq::fd_t zmq::ysocketpair_t::get_fd ()
@@ -183,23 +179,21 @@ zmq::ysocketpair_t::~ysocketpair_t ()
 
 void zmq::ysocketpair_t::signal (int signal_)
 {
-    assert (signal_ >= 0 && signal_ < 64);
-    unsigned char c = (unsigned char) signal_;
+    if (!set.set (signal_))
+        return;
+    counter_add (counter_signaler_wakeups, 1);
+    unsigned char c = 0;
     ssize_t nbytes = send (w, &c, 1, 0);
     errno_assert (nbytes == 1);
 }
 
-zmq::ysocketpair_t::integer_t zmq::ysocketpair_t::check ()
+void zmq::ysocketpair_t::reset ()
 {
     unsigned char buffer [32];
     ssize_t nbytes = recv (r, buffer, 32, 0);
+    if (nbytes == -1 && errno == EAGAIN)
+        return;
     errno_assert (nbytes != -1);
-    integer_t signals = 0;
-    for (int pos = 0; pos != nbytes; pos ++) {
-        assert (buffer [pos] < 64);
-        signals |= (integer_t (1) << (buffer [pos]));
-    }
-    return signals;
 }
 
 zmq::fd_t zmq::ysocketpair_t::get_fd ()
@@ -210,6 +204,11 @@ zmq::fd_t zmq::ysocketpair_t::get_fd ()
 #endif
 
 
+bool zmq::ysocketpair_t::check (signals_t &signals_, bool park_)
+{
+    return set.get (signals_, park_);
+}
+
 #if defined ZMQ_HAVE_OPENVMS
 
 int zmq::ysocketpair_t::socketpair (int domain_, int type_, int protocol_,
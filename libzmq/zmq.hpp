@@ -31,6 +31,7 @@
 #include <zmq/devpoll_thread.hpp>
 #include <zmq/kqueue_thread.hpp>
 #include <zmq/wire.hpp>
+#include <zmq/counters.hpp>
 
 #endif
 
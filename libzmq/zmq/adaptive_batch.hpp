@@ -0,0 +1,139 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __ZMQ_ADAPTIVE_BATCH_HPP_INCLUDED__
+#define __ZMQ_ADAPTIVE_BATCH_HPP_INCLUDED__
+
+#include <stddef.h>
+#include <algorithm>
+
+#include <zmq/config.hpp>
+#include <zmq/counters.hpp>
+
+namespace zmq
+{
+
+    //  Chooses size of read or write batches for a single connection.
+    //  After each I/O operation the engine reports how many bytes were
+    //  actually transferred. If the whole batch was used, more data are
+    //  probably waiting, so the batch size is doubled (up to 'max_'). If less
+    //  than a quarter of the batch was used batch_shrink_delay times in
+    //  a row, traffic is light and the batch size is halved (down to 'min_').
+    //  Sizes are reported to the process-wide counters.
+
+    class adaptive_batch_t
+    {
+    public:
+
+        inline adaptive_batch_t (bool in_, size_t initial_, size_t min_,
+              size_t max_) :
+            in (in_),
+            min_size (initial_),
+            max_size (initial_),
+            current (initial_),
+            underfills (0)
+        {
+            counter_add (in ? counter_in_batch_size : counter_out_batch_size,
+                current);
+            counter_add (in ? counter_in_batches : counter_out_batches, 1);
+            set_bounds (min_, max_);
+        }
+
+        inline ~adaptive_batch_t ()
+        {
+            counter_sub (in ? counter_in_batch_size : counter_out_batch_size,
+                current);
+            counter_sub (in ? counter_in_batches : counter_out_batches, 1);
+        }
+
+        //  Changes the bounds for the batch size. Current size is adjusted
+        //  to fit into the new bounds.
+        inline void set_bounds (size_t min_, size_t max_)
+        {
+            min_size = min_ ? min_ : 1;
+            max_size = std::max (max_, min_size);
+            if (current < min_size || current > max_size)
+                resize (std::max (min_size, std::min (current, max_size)),
+                    counter_count);
+        }
+
+        //  Returns current batch size.
+        inline size_t size ()
+        {
+            return current;
+        }
+
+        //  Reports number of bytes transferred by the last operation.
+        inline void update (size_t used_)
+        {
+            if (used_ >= current) {
+                underfills = 0;
+                if (current < max_size)
+                    resize (std::min (current * 2, max_size),
+                        in ? counter_in_batch_grows : counter_out_batch_grows);
+                return;
+            }
+
+            if (used_ >= current / 4 || current == min_size) {
+                underfills = 0;
+                return;
+            }
+
+            underfills ++;
+            if (underfills == batch_shrink_delay) {
+                underfills = 0;
+                resize (std::max (current / 2, min_size),
+                    in ? counter_in_batch_shrinks : counter_out_batch_shrinks);
+            }
+        }
+
+    private:
+
+        //  Sets new batch size. 'counter_' is the grow/shrink counter to
+        //  update, counter_count means no update.
+        inline void resize (size_t size_, counter_id_t counter_)
+        {
+            counter_id_t size_counter =
+                in ? counter_in_batch_size : counter_out_batch_size;
+            counter_sub (size_counter, current);
+            counter_add (size_counter, size_);
+            if (counter_ != counter_count)
+                counter_add (counter_, 1);
+            current = size_;
+        }
+
+        //  True for read batches, false for write batches.
+        bool in;
+
+        //  Bounds for the batch size and the current batch size.
+        size_t min_size;
+        size_t max_size;
+        size_t current;
+
+        //  Number of consecutive operations that used less than a quarter
+        //  of the batch.
+        int underfills;
+
+        adaptive_batch_t (const adaptive_batch_t&);
+        void operator = (const adaptive_batch_t&);
+    };
+
+}
+
+#endif
@@ -31,6 +31,7 @@
 #include <zmq/i_poller.hpp>
 #include <zmq/i_pollable.hpp>
 #include <zmq/engine_base.hpp>
+#include <zmq/adaptive_batch.hpp>
 #include <zmq/tcp_socket.hpp>
 #include <zmq/amqp_encoder.hpp>
 #include <zmq/amqp_decoder.hpp>
@@ -63,6 +64,7 @@ namespace zmq
         void out_event ();
         void timer_event ();
         void unregister_event ();
+        bool detach_event ();
 
     private:
 
@@ -172,6 +174,12 @@ namespace zmq
         //  Arguments to use to initialise AMQP environment.
         std::string arguments;
 
+        //  Sizes of read and write batches adapted to the traffic. As
+        //  engine arguments are used to initialise AMQP environment, default
+        //  bounds are used.
+        adaptive_batch_t in_batch;
+        adaptive_batch_t out_batch;
+
         amqp_client_t (const amqp_client_t&);
         void operator = (const amqp_client_t&);
     };
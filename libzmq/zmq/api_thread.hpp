@@ -33,8 +33,10 @@
 #include <zmq/dispatcher.hpp>
 #include <zmq/ypollset.hpp>
 #include <zmq/scope.hpp>
+#include <zmq/style.hpp>
 #include <zmq/in_engine.hpp>
 #include <zmq/out_engine.hpp>
+#include <zmq/shared_exchange.hpp>
 
 //  If the RDTSC is available we use it to prevent excessive
 //  polling for commands. The nice thing here is that it will work on any
@@ -47,17 +49,35 @@
 namespace zmq
 {
 
-    //  Different styles of routing the messages.
-    enum style_t
+    enum
     {
-        style_data_distribution = 1,
-        style_load_balancing = 2
+        no_limit = -1,
+        no_swap = 0,
+        no_conflate = 0
     };
 
-    enum
+    //  Stages of waiting for a message in blocking receive. Stage reports
+    //  how the receive was satisfied (see api_thread_t::receive_policy).
+    enum receive_stage_t
     {
-        no_limit = -1,
-        no_swap = 0
+        receive_immediate,
+        receive_spin,
+        receive_yield,
+        receive_park,
+        receive_stage_count
+    };
+
+    //  Statistics of blocking receives done by an API thread.
+    struct receive_stats_t
+    {
+        //  Number of receives satisfied at each of the stages.
+        uint64_t stages [receive_stage_count];
+
+        //  Histogram of waiting times. Bucket N is the number of receives
+        //  that waited for 2^N to 2^(N+1)-1 CPU cycles. Receives that have
+        //  not waited at all are not included. Filled in only on platforms
+        //  with RDTSC instruction.
+        uint64_t wait_cycles [64];
     };
 
     //  Thread object to be used as a proxy for client application thread.
@@ -69,9 +89,11 @@ namespace zmq
     public:
 
         //  Creates API thread and attaches it to the command dispatcher and
-        //  resource locator.
+        //  resource locator. If 'affinity_' is non-zero, the calling
+        //  application thread is pinned to the specified CPUs (see
+        //  thread_t::set_affinity) before any of its resources are allocated.
         ZMQ_EXPORT static api_thread_t *create (dispatcher_t *dispatcher_,
-            i_locator *locator_);
+            i_locator *locator_, uint64_t affinity_ = 0);
 
         //  Allows user to specify which notifications to receive.
         //  Use binary OR operator to combine individual notification types into
@@ -86,15 +108,19 @@ namespace zmq
             int handler_thread_count_ = 0, i_thread **handler_threads_ = NULL,
             style_t style_ = style_data_distribution);
 
-        //  Creates new queue, returns queue ID.
+        //  Creates new queue, returns queue ID. If 'conflate_' is non-zero,
+        //  the queue keeps only the latest unread message for each key,
+        //  key being the first 'conflate_' bytes of the message.
         ZMQ_EXPORT int create_queue (
             const char *name_, scope_t scope_ = scope_local,
             const char *location_ = NULL, i_thread *listener_thread_ = NULL,
             int handler_thread_count_ = 0, i_thread **handler_threads_ = NULL,
             int64_t hwm_ = no_limit, int64_t lwm_ = no_limit,
-            uint64_t swap_ = no_swap);
+            uint64_t swap_ = no_swap, size_t conflate_ = no_conflate);
 
-        //  Binds an exchange to a queue.
+        //  Binds an exchange to a queue. If either of the option strings
+        //  contains "subscribe=<topic>" options, the queue gets only
+        //  the messages beginning with one of the topics.
         ZMQ_EXPORT void bind (const char *exchange_name_,
             const char *queue_name_, i_thread *exchange_thread_,
             i_thread *queue_thread_, const char *exchange_options_ = NULL,
@@ -116,14 +142,57 @@ namespace zmq
         ZMQ_EXPORT bool presend (int exchange_, message_t &message_,
             bool block_ = true);
 
+        //  Send 'count_' messages from the 'msgs_' array to the specified
+        //  exchange in one go. Commands are processed and the exchange is
+        //  flushed only once for the whole array. If 'block' parameter is
+        //  true, execution is blocked till all the messages are enqueued.
+        //  Returns number of messages successfully enqueued. 0MQ takes
+        //  responsibility for deallocating the enqueued messages.
+        ZMQ_EXPORT size_t send_many (int exchange_, message_t *msgs_,
+            size_t count_, bool block_ = true);
+
         //  Flush all the pre-sent messages.
         ZMQ_EXPORT void flush ();
 
+        //  Returns front-end to the exchange that can be used to send
+        //  messages from other threads. The messages are written to the
+        //  exchange by this thread whenever it calls into 0MQ; a thread
+        //  blocked in 'receive' is woken up to do so. Repeated calls for
+        //  the same exchange return the same object. It is destroyed
+        //  together with the API thread.
+        ZMQ_EXPORT shared_exchange_t *share_exchange (int exchange_);
+
         //  Receive a message. If 'block' argument is true, it'll block till
         //  message arrives. It returns ID of the queue message was retrieved
         //  from, 0 is no message was retrieved.
         ZMQ_EXPORT int receive (message_t *message_, bool block_ = true);
 
+        //  Receive up to 'count_' messages in one go. All the messages are
+        //  retrieved from a single queue. If 'block' argument is true, it'll
+        //  block till at least one message arrives. Returns number of messages
+        //  retrieved. ID of the queue the messages were retrieved from is
+        //  stored in 'qid_' (0 if no message was retrieved).
+        ZMQ_EXPORT size_t receive_many (message_t *messages_, size_t count_,
+            int *qid_ = NULL, bool block_ = true);
+
+        //  Sets how blocking receive waits when there are no messages
+        //  available. The thread first busy-waits for 'spin_cycles_' CPU
+        //  cycles, then yields the CPU up to 'yield_count_' times and only
+        //  then goes asleep. By default it goes asleep immediately. Spinning
+        //  requires RDTSC instruction, elsewhere 'spin_cycles_' is ignored.
+        ZMQ_EXPORT void receive_policy (uint64_t spin_cycles_,
+            int yield_count_);
+
+        //  Retrieves the statistics of blocking receives done so far.
+        ZMQ_EXPORT void get_receive_stats (receive_stats_t *stats_);
+
+        //  Returns number of messages the exchange has dropped so far
+        //  instead of passing them to the queue because the queue was full
+        //  (see "overflow" option of 'bind'). Only the exchanges created
+        //  by this API thread are accounted for.
+        ZMQ_EXPORT uint64_t get_dropped (const char *exchange_name_,
+            const char *queue_name_);
+
     private:
 
         api_thread_t (dispatcher_t *dispatcher_, i_locator *locator_);
@@ -137,9 +206,31 @@ namespace zmq
         void destroy ();
 
         int fetch_message (message_t *message_);
+        size_t fetch_messages (message_t *messages_, size_t count_, int *qid_);
         int blocking_receive (message_t *message);
         int non_blocking_receive (message_t *message);
 
+        //  Waits for commands as specified by the receive policy and
+        //  processes them. 'start_' is the time when the receive started
+        //  to wait. Returns the stage the commands were received at.
+        receive_stage_t wait_for_commands (uint64_t start_);
+
+        //  Updates receive statistics.
+        void record_receive (receive_stage_t stage_, uint64_t start_);
+
+        //  Links the queue into the ring of ready queues if there may be
+        //  messages available in it. It is visited last in the current
+        //  round.
+        void activate_queue (in_engine_t *queue_);
+
+        //  Unlinks the queue with the specified ID from the ring of ready
+        //  queues. If it is the current queue, the next one becomes current.
+        void deactivate_queue (size_t qid_);
+
+        //  If the pipe of the exchange may drop messages, starts counting
+        //  the drops (see get_dropped).
+        void count_drops (out_engine_t *exchange_, class pipe_t *pipe_);
+
         //  Processes single command.
         void process_command (const command_t &command_);
 
@@ -147,7 +238,7 @@ namespace zmq
         void process_commands ();
 
         //  Processes available commands. Signals are supplied by the caller.
-        void process_commands (ypollset_t::integer_t signals_);
+        void process_commands (signals_t &signals_);
 
         //  Determines when we are going to poll in 'receive' function. See
         //  api_thread_poll_rate's description in config.hpp to get better
@@ -163,6 +254,9 @@ namespace zmq
         //  Thread ID assigned to this thread by dispatcher.
         int thread_id;
 
+        //  Message cache the application thread uses, NULL if none.
+        message_cache_t *message_cache;
+
         //  Used to poll for signals coming from other threads.
         ypollset_t pollset;
 
@@ -171,14 +265,43 @@ namespace zmq
             exchanges_t;
         exchanges_t exchanges;
 
+        //  Front-ends of the exchanges shared with other threads.
+        typedef std::vector <shared_exchange_t*> shared_exchanges_t;
+        shared_exchanges_t shared_exchanges;
+
+        //  Bindings of the exchanges belonging to the API thread that may
+        //  drop messages, with the number of messages dropped so far.
+        struct binding_t
+        {
+            std::string exchange_name;
+            std::string queue_name;
+            uint64_t dropped;
+        };
+        typedef std::vector <binding_t*> bindings_t;
+        bindings_t bindings;
+
         //  List of queues belonging to the API thread.
         typedef std::vector <std::pair <std::string, in_engine_t*> >
             queues_t;
         queues_t queues;
 
-        //  Current queue points to the queue to be used to retrieving
+        //  Ready queues, i.e. those that may contain messages, are linked
+        //  into a ring in the order they became ready. The rest of the queues
+        //  is idle until one of their pipes is revived. Links of the queue
+        //  are stored at the same position as the queue in 'queues'.
+        struct queue_link_t
+        {
+            bool ready;
+            queues_t::size_type prev;
+            queues_t::size_type next;
+        };
+        typedef std::vector <queue_link_t> queue_links_t;
+        queue_links_t queue_links;
+        queues_t::size_type ready_queues;
+
+        //  Current queue points to the ready queue to be used to retrieving
         //  next message.
-        queues_t::size_type current_queue; 
+        queues_t::size_type current_queue;
 
         //  Filter specifying what types of messages are wanted by user.
         //  Oher message types are dropped silently.
@@ -191,6 +314,13 @@ namespace zmq
         uint64_t last_command_time; 
 #endif
 
+        //  Receive policy (see receive_policy).
+        uint64_t spin_cycles;
+        int yield_count;
+
+        //  Statistics of blocking receives.
+        receive_stats_t receive_stats;
+
         api_thread_t (const api_thread_t&);
         void operator = (const api_thread_t&);
     };
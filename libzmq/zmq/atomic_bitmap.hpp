@@ -144,6 +144,62 @@ namespace zmq
 #endif
         }
 
+        //  Bit-test-and-set. Sets one bit of the value. Returns the original
+        //  value of the bit.
+        inline bool bts (int index_)
+        {
+#if defined ZMQ_ATOMIC_BITMAP_WINDOWS
+            while (true) {
+                integer_t oldval = value;
+                integer_t newval = oldval | (integer_t (1) << index_);
+                if (InterlockedCompareExchange ((volatile LONG*) &value, newval,
+                      oldval) == (LONG) oldval)
+                    return (oldval & (integer_t (1) << index_)) ? true : false;
+            }
+#elif defined ZMQ_ATOMIC_BITMAP_SOLARIS
+            while (true) {
+                integer_t oldval = value;
+                integer_t newval = oldval | (integer_t (1) << index_);
+                if (atomic_cas_32 (&value, oldval, newval) == oldval)
+                    return (oldval & (integer_t (1) << index_)) ? true : false;
+            }
+#elif defined ZMQ_ATOMIC_BITMAP_X86
+            unsigned char oldbit;
+            __asm__ volatile (
+                "lock bts %2, %0\n\t"
+                "setc %1\n\t"
+                : "+m" (value), "=q" (oldbit)
+                : "r" (integer_t(index_))
+                : "cc");
+            return (bool) oldbit;
+#elif defined ZMQ_ATOMIC_BITMAP_SPARC
+            volatile integer_t* valptr = &value;
+            integer_t set_val = integer_t(1) << index_;
+            integer_t tmp;
+            integer_t oldval;
+            __asm__ volatile(
+                "ld       [%4], %1       \n\t" 
+                "1:                      \n\t" 
+                "or       %1, %0, %2     \n\t" 
+                "cas      [%4], %1, %2   \n\t"
+                "cmp      %1, %2         \n\t"
+                "bne,a,pn %%icc, 1b      \n\t"
+                "mov      %2, %1         \n\t"
+                : "+r" (set_val), "=&r" (tmp), "=&r" (oldval), "+m" (*valptr)
+                : "r" (valptr)
+                : "cc");
+            return (oldval & (integer_t (1) << index_)) ? true : false;
+#elif defined ZMQ_ATOMIC_BITMAP_MUTEX
+            sync.lock ();
+            integer_t oldval = value;
+            value = oldval | (integer_t (1) << index_);
+            sync.unlock ();
+            return (oldval & (integer_t (1) << index_)) ? true : false;
+#else
+#error
+#endif
+        }
+
         //  Sets value to newval. Returns the original value.
         inline integer_t xchg (integer_t newval_)
         {
@@ -73,6 +73,12 @@ namespace zmq
             value = value_;
         }
 
+        //  Get counter value (not thread-safe).
+        inline integer_t get ()
+        {
+            return value;
+        }
+
         //  Atomic addition. Returns the old value.
         inline integer_t add (integer_t increment_)
         {
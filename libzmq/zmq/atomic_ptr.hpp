@@ -73,6 +73,13 @@ namespace zmq
             this->ptr = ptr_;
         }
 
+        //  Get value of atomic pointer. Use this function only to read
+        //  a pointer that is never changed once it is set to non-NULL value.
+        inline T *get ()
+        {
+            return (T*) ptr;
+        }
+
         //  Perform atomic 'exchange pointers' operation. Pointer is set
         //  to the 'val' value. Old value is returned.
         inline T *xchg (T *val_)
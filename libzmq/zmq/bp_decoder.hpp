@@ -23,6 +23,7 @@
 
 #include <zmq/i_demux.hpp>
 #include <zmq/decoder.hpp>
+#include <zmq/message.hpp>
 
 namespace zmq
 {
@@ -37,16 +38,31 @@ namespace zmq
         //  Clears any partially decoded messages.
         void reset ();
 
+        //  Returns a buffer of 'size_' bytes to read the data into. The data
+        //  are then passed to 'write' as usual. Message bodies that are fully
+        //  contained in the buffer are not copied, instead, they reference
+        //  the buffer directly (zero-copy). The buffer is freed once all
+        //  the messages referencing it are destroyed.
+        unsigned char *get_buffer (size_t size_);
+
     private:
 
         bool one_byte_size_ready ();
         bool eight_byte_size_ready ();
         bool message_ready ();
 
+        //  Prepares reading of message body 'size_' bytes long.
+        void body_ready (size_t size_);
+
         i_demux *demux;
         unsigned char tmpbuf [8];
         message_t message;
 
+        //  Buffer returned by 'get_buffer'. If 'sliced' is true, there are
+        //  messages referencing the buffer, so it cannot be reused.
+        message_t buffer;
+        bool sliced;
+
         bp_decoder_t (const bp_decoder_t&);
         void operator = (const bp_decoder_t&);
     };
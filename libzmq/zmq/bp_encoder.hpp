@@ -27,6 +27,7 @@
 #include <zmq/mux.hpp>
 #include <zmq/encoder.hpp>
 #include <zmq/message.hpp>
+#include <zmq/config.hpp>
 
 namespace zmq
 {
@@ -34,6 +35,9 @@ namespace zmq
 
     class bp_encoder_t : public encoder_t <bp_encoder_t>
     {
+        //  Allow base class to hold and release the messages.
+        friend class encoder_t <bp_encoder_t>;
+
     public:
 
         bp_encoder_t (mux_t *mux_);
@@ -46,8 +50,23 @@ namespace zmq
         bool size_ready ();
         bool message_ready ();
 
+        //  Keeps the body of the current message referenced by 'read_iov'.
+        //  Subsequent messages are read into the next slot.
+        void hold ();
+
+        //  Releases all the held messages.
+        void release ();
+
         mux_t *mux;
-        message_t message;
+
+        //  Ring of messages. Message being encoded is at position 'current',
+        //  'held' messages preceding it are referenced by the last batch.
+        //  There's one slot more than there can be held messages so that
+        //  there's always a free slot to encode the next message in.
+        message_t messages [max_io_vectors + 1];
+        int current;
+        int held;
+
         unsigned char tmpbuf [9];
 
         bp_encoder_t (const bp_encoder_t&);
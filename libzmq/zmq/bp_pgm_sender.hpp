@@ -61,6 +61,7 @@ namespace zmq
         void out_event ();
         void timer_event ();
         void unregister_event ();
+        bool detach_event ();
 
     private:
 
@@ -27,10 +27,13 @@
 #include <zmq/i_pollable.hpp>
 #include <zmq/i_thread.hpp>
 #include <zmq/engine_base.hpp>
+#include <zmq/adaptive_batch.hpp>
 #include <zmq/bp_encoder.hpp>
 #include <zmq/bp_decoder.hpp>
 #include <zmq/tcp_socket.hpp>
 #include <zmq/tcp_listener.hpp>
+#include <zmq/io_vector.hpp>
+#include <zmq/config.hpp>
 
 namespace zmq
 {
@@ -68,6 +71,7 @@ namespace zmq
         void out_event ();
         void timer_event ();
         void unregister_event ();
+        bool detach_event ();
 
     private:
 
@@ -91,14 +95,18 @@ namespace zmq
         //  Creates bp_tcp_engine. Underlying TCP connection is initialised
         //  using hostname parameter. Local object name is simply stored
         //  and passed to error handler function when connection breaks.
+        //  'arguments_' are the engine options (see engine_options_t).
         bp_tcp_engine_t (i_thread *calling_thread_, i_thread *thread_,
             const char *hostname_, const char *local_object_,
-            const char * /* arguments_*/);
+            const char *arguments_);
         bp_tcp_engine_t (i_thread *calling_thread_, i_thread *thread_,
-            fd_t fd_, const char *local_object_);
+            fd_t fd_, const char *local_object_, const char *arguments_);
 
         ~bp_tcp_engine_t ();
 
+        //  Applies the engine options and allocates the buffers.
+        void init (const char *arguments_);
+
         //  Handle connection error.
         void error ();
 
@@ -108,11 +116,17 @@ namespace zmq
         //  Initialise engine shutdown.
         void shutdown ();
 
-        //  Buffer to be written to the underlying socket.
+        //  Buffer to be written to the underlying socket. Small data blocks
+        //  are copied to 'writebuf', large message bodies are referenced
+        //  directly. The batch itself is described by 'iov' array. Bytes
+        //  already written are removed from the beginning of the array.
         unsigned char *writebuf;
         int writebuf_size;
-        int write_size;
-        int write_pos;
+        size_t write_size;
+        size_t write_pos;
+        io_vector_t iov [max_io_vectors];
+        int iov_count;
+        int iov_pos;
 
         //  Buffer to read from undrlying socket.
         unsigned char *readbuf;
@@ -149,6 +163,32 @@ namespace zmq
         //  Underlying TCP/IP socket.
         tcp_socket_t socket;
 
+        //  If true, data are read into buffers supplied by the decoder
+        //  and decoded messages reference the buffers rather than having
+        //  their bodies copied. Switched on by "zero_copy_in=1" option.
+        bool zero_copy_in;
+
+        //  Maximal number of bytes read from the socket in a single
+        //  in_event. Once the socket is drained or the budget is exhausted
+        //  the control is yielded back to the poller. Zero means that only
+        //  a single read is done per event. Set by "read_budget" option.
+        size_t read_budget;
+
+        //  Maximal number of bytes written to the socket in a single
+        //  out_event. Set by "write_budget" option.
+        size_t write_budget;
+
+        //  If true, edge-triggered notifications are requested from the
+        //  poller once the connection is established. Set by
+        //  "edge_triggered" option.
+        bool edge_triggered;
+
+        //  Sizes of read and write batches. They are adapted to the traffic
+        //  within the bounds set by "in_batch_min", "in_batch_max",
+        //  "out_batch_min" and "out_batch_max" options.
+        adaptive_batch_t in_batch;
+        adaptive_batch_t out_batch;
+
         bp_tcp_engine_t (const bp_tcp_engine_t&);
         void operator = (const bp_tcp_engine_t&);
     };
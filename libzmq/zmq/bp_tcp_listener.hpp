@@ -21,6 +21,7 @@
 #define __ZMQ_BP_TCP_LISTENER_HPP_INCLUDED__
 
 #include <vector>
+#include <string>
 
 #include <zmq/stdint.hpp>
 #include <zmq/i_pollable.hpp>
@@ -55,16 +56,18 @@ namespace zmq
         void out_event ();
         void timer_event ();
         void unregister_event ();
+        bool detach_event ();
 
     private:
 
         //  Creates a BP listener. Handler thread array determines
         //  the threads that will serve newly-created BP engines.
+        //  'engine_options_' are passed to the newly-created BP engines.
         bp_tcp_listener_t (i_thread *calling_thread_, i_thread *thread_,
             const char *interface_, int handler_thread_count_,
             i_thread **handler_threads_, bool source_,
             i_thread *peer_thread_, i_engine *peer_engine_,
-            const char *peer_name_);
+            const char *peer_name_, const char *engine_options_);
         ~bp_tcp_listener_t ();
 
         //  Determines whether the engine serves as a local source of messages
@@ -82,6 +85,9 @@ namespace zmq
         i_engine *peer_engine;
         char peer_name [256];
 
+        //  Options for the newly-created BP engines.
+        std::string engine_options;
+
         //  Arguments string for this listener.
         char arguments [256];
 
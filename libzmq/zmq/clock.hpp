@@ -0,0 +1,67 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __ZMQ_CLOCK_HPP_INCLUDED__
+#define __ZMQ_CLOCK_HPP_INCLUDED__
+
+#include <zmq/platform.hpp>
+#include <zmq/stdint.hpp>
+#include <zmq/err.hpp>
+
+#if defined ZMQ_HAVE_WINDOWS
+#include <zmq/windows.hpp>
+#else
+#include <time.h>
+#include <sys/time.h>
+#endif
+
+namespace zmq
+{
+
+    //  Returns current time in milliseconds. The value is intended to
+    //  measure time intervals rather than to tell the time of day. Where
+    //  available, monotonic clock is used so that the value is not affected
+    //  by the adjustments of the system time. On Windows, performance
+    //  counter is used as GetTickCount wraps around after 49.7 days.
+    inline uint64_t clock_ms ()
+    {
+#if defined ZMQ_HAVE_WINDOWS
+        LARGE_INTEGER frequency;
+        BOOL rc = QueryPerformanceFrequency (&frequency);
+        win_assert (rc);
+        LARGE_INTEGER ticks;
+        rc = QueryPerformanceCounter (&ticks);
+        win_assert (rc);
+        return (uint64_t) (ticks.QuadPart / (frequency.QuadPart / 1000));
+#elif defined CLOCK_MONOTONIC
+        timespec ts;
+        int rc = clock_gettime (CLOCK_MONOTONIC, &ts);
+        errno_assert (rc == 0);
+        return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#else
+        timeval tv;
+        int rc = gettimeofday (&tv, NULL);
+        errno_assert (rc == 0);
+        return (uint64_t) tv.tv_sec * 1000 + tv.tv_usec / 1000;
+#endif
+    }
+
+}
+
+#endif
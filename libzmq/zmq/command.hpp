@@ -22,6 +22,7 @@
 
 #include <assert.h>
 #include <string.h>
+#include <vector>
 
 #include <zmq/stdint.hpp>
 #include <zmq/i_engine.hpp>
@@ -78,6 +79,10 @@ namespace zmq
             stop,
             register_engine,
             unregister_engine,
+            adopt_engine,
+            rehome_pipe,
+            rehome_pipe_ack,
+            resume_engine,
             engine_command
         } type;
 
@@ -91,6 +96,21 @@ namespace zmq
             struct {
                 i_engine *engine;
             } unregister_engine;
+            struct {
+                i_engine *engine;
+            } adopt_engine;
+            struct {
+                class pipe_t *pipe;
+                i_engine *engine;
+                struct i_thread *thread;
+            } rehome_pipe;
+            struct {
+                i_engine *engine;
+            } rehome_pipe_ack;
+            struct {
+                i_engine *engine;
+                std::vector <command_t> *commands;
+            } resume_engine;
             struct {
                 i_engine *engine;
                 engine_command_t command;
@@ -114,6 +134,46 @@ namespace zmq
             args.unregister_engine.engine = engine_;
         }
 
+        //  Engine migration between I/O threads. The old thread of the engine
+        //  stops polling on behalf of the engine and sends 'adopt_engine' to
+        //  the new thread. The new thread asks the threads on the other
+        //  ends of the engine's pipes to redirect the pipes to it using
+        //  'rehome_pipe'. Each of them acknowledges the redirection to the
+        //  old thread using 'rehome_pipe_ack'. Once all the pipes are
+        //  acknowledged, no more commands for the engine can arrive at the
+        //  old thread and it passes the commands it has held for the engine
+        //  to the new thread in 'resume_engine'. The new thread executes
+        //  them followed by the commands it has held itself meanwhile.
+
+        inline void init_adopt_engine (i_engine *engine_)
+        {
+            type = adopt_engine;
+            args.adopt_engine.engine = engine_;
+        }
+
+        inline void init_rehome_pipe (pipe_t *pipe_, i_engine *engine_,
+            struct i_thread *thread_)
+        {
+            type = rehome_pipe;
+            args.rehome_pipe.pipe = pipe_;
+            args.rehome_pipe.engine = engine_;
+            args.rehome_pipe.thread = thread_;
+        }
+
+        inline void init_rehome_pipe_ack (i_engine *engine_)
+        {
+            type = rehome_pipe_ack;
+            args.rehome_pipe_ack.engine = engine_;
+        }
+
+        inline void init_resume_engine (i_engine *engine_,
+            std::vector <command_t> *commands_)
+        {
+            type = resume_engine;
+            args.resume_engine.engine = engine_;
+            args.resume_engine.commands = commands_;
+        }
+
         inline void init_engine_send_to (i_engine *engine_, pipe_t *pipe_)
         {
             type = engine_command;
@@ -20,6 +20,8 @@
 #ifndef __ZMQ_CONFIG_HPP_INCLUDED__
 #define __ZMQ_CONFIG_HPP_INCLUDED__
 
+#include <zmq/platform.hpp>
+
 namespace zmq
 {
 
@@ -67,17 +69,82 @@ namespace zmq
         //  unnecessary network stack traversals.
         bp_out_batch_size = 8192,
 
+        //  Bounds for adaptive batch sizes of the backend protocol engines.
+        //  Batch sizes start at bp_in_batch_size and bp_out_batch_size and
+        //  are adjusted to the traffic within these bounds. The bounds can
+        //  be overriden per connection using engine options.
+        bp_min_batch_size = 1024,
+        bp_max_batch_size = 65536,
+
+        //  Number of consecutive I/O operations that have to use less than
+        //  a quarter of the batch before the batch size is halved.
+        batch_shrink_delay = 16,
+
+        //  Maximal number of bytes backend protocol engine reads from the
+        //  socket speculatively, without returning to the poller, when
+        //  processing a single input event.
+        bp_read_budget = 65536,
+
+        //  Maximal number of bytes backend protocol engine writes to the
+        //  socket when processing a single output event.
+        bp_write_budget = 65536,
+
+        //  If 1, backend protocol engines ask the poller for edge-triggered
+        //  notifications (where supported) rather than for level-triggered
+        //  ones. Can be overridden per connection by "edge_triggered"
+        //  engine option.
+        bp_edge_triggered = 0,
+
+        //  Data blocks (message bodies) at least this long are not copied
+        //  into the outgoing batch. Instead they are passed to the socket
+        //  directly using scatter-gather I/O.
+        zero_copy_threshold = 1024,
+
+        //  Maximal number of data blocks passed to a single scatter-gather
+        //  write operation.
+        max_io_vectors = 16,
+
         //  Number of new messages in message pipe needed to trigger new memory
         //  allocation.
         message_pipe_granularity = 256,
 
+        //  Maximal number of messages a conflating queue moves from its pipes
+        //  to the conflation buffer when a message is read. Prevents a reader
+        //  from being kept busy conflating by a faster writer forever.
+        max_conflate_batch = 65536,
+
         //  Number of new commands in command pipe needed to trigger new memory
         //  allocation.
         command_pipe_granularity = 16,
 
+        //  Size of CPU cache line. Data structures accessed by different
+        //  threads are padded to this size to prevent false sharing.
+        cache_line_size = 64,
+
         //  Maximal size of "Very Small Message". VSMs are passed by value
         //  to avoid excessive memory allocation/deallocation.
+        //  If ZMQ_MESSAGE_SIZE is set at build time, raw_message_t is exactly
+        //  that many bytes long and VSMs use all the space left after
+        //  the message header (content pointer, 'shared' flag, VSM size).
+        //  Setting it to a multiple of cache line size makes messages
+        //  in the pipes never straddle cache lines.
+#if defined ZMQ_MESSAGE_SIZE
+        max_vsm_size = ZMQ_MESSAGE_SIZE - sizeof (void*) - 4,
+#else
         max_vsm_size = 30,
+#endif
+
+        //  Message pool (if switched on in dispatcher) allocates message
+        //  contents in size classes. Size classes are powers of two ranging
+        //  from message_pool_min_size to message_pool_max_size bytes.
+        //  Larger messages are allocated using malloc.
+        message_pool_min_size = 64,
+        message_pool_max_size = 4096,
+        message_pool_class_count = 7,
+
+        //  Maximal number of free blocks per size class kept in the message
+        //  cache of a single thread.
+        message_cache_max_blocks = 1024,
 
         //  Determines how often does api_thread poll for new messages when it
         //  still has unprocessed messages to handle. Thus, if it is set to 100,
@@ -87,6 +154,15 @@ namespace zmq
         //  behaviour (less latency peaks).
         api_thread_poll_rate = 100,
 
+        //  Number of times a thread checks for signals before going asleep
+        //  when there is nothing to do. Spinning avoids the cost of going
+        //  asleep and being woken up when the peer answers quickly (e.g. in
+        //  request/reply scenarios) at the cost of burning CPU. Zero means
+        //  the thread goes asleep immediately. API threads and I/O threads
+        //  can be tuned separately.
+        api_thread_spin_count = 0,
+        io_thread_spin_count = 0,
+
         //  Maximal delay to process command in API thread (in CPU tics).
         //  This setting is used only on x86 platform with GCC or MSVC compiler.
         api_thread_max_command_delay = 3000000,
@@ -105,8 +181,20 @@ namespace zmq
         //  limit for SCTP message size.
         max_sctp_message_size = 4096,
 
-        //  Maximal wait time when engine sets timer (milliseconds).
-        max_timer_period = 100
+        //  Length of the window over which the load of I/O threads in a pool
+        //  is measured (milliseconds) and minimal difference between loads
+        //  of two threads in the pool (events per window) to move an engine
+        //  from one to the other.
+        io_pool_window = 200,
+        io_pool_min_imbalance = 100,
+
+        //  Maximal time an I/O thread in a pool waits for events before
+        //  checking its load (milliseconds).
+        max_timer_period = 100,
+
+        //  Time to wait before attempting to reconnect after a failed
+        //  connection attempt (milliseconds).
+        reconnect_period = 100
     };
 
 }
@@ -0,0 +1,106 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __ZMQ_COUNTERS_HPP_INCLUDED__
+#define __ZMQ_COUNTERS_HPP_INCLUDED__
+
+#include <zmq/platform.hpp>
+#include <zmq/export.hpp>
+#include <zmq/stdint.hpp>
+
+namespace zmq
+{
+
+    //  Process-wide performance counters. They can be updated from any
+    //  thread. Counters are intended for monitoring and tuning, thus they
+    //  are read without any synchronisation and they wrap around on overflow.
+    //
+    //  Counters are compiled in only if ZMQ_HAVE_COUNTERS is defined
+    //  (--enable-counters, -DWITH_COUNTERS=ON). Otherwise updating a counter
+    //  is a no-op and all the counters read as zero.
+
+    enum counter_id_t
+    {
+        //  Sum of current read (write) batch sizes of all the connections
+        //  in bytes and number of the connections. Average batch size is
+        //  the former divided by the latter.
+        counter_in_batch_size,
+        counter_in_batches,
+        counter_out_batch_size,
+        counter_out_batches,
+
+        //  Number of times read (write) batch size was increased or
+        //  decreased.
+        counter_in_batch_grows,
+        counter_in_batch_shrinks,
+        counter_out_batch_grows,
+        counter_out_batch_shrinks,
+
+        //  Number of additional reads done within a single input event and
+        //  number of times the reading stopped because read budget was
+        //  exhausted rather than because there were no more data.
+        counter_speculative_reads,
+        counter_read_budget_hits,
+
+        //  Number of system calls done by epoll-based I/O threads (waits
+        //  for events and changes of the polling set) and by backend
+        //  protocol engines (socket reads and writes).
+        counter_poller_waits,
+        counter_poller_changes,
+        counter_socket_reads,
+        counter_socket_writes,
+
+        //  Number of system calls done to wake up a thread waiting for
+        //  signals (signaler file descriptor writes and futex wake-ups).
+        counter_signaler_wakeups,
+
+        //  Number of messages dropped because the pipe they were to be
+        //  written to was full (see pipe_t::set_overflow).
+        counter_overflow_drops,
+
+        //  Number of counters. Keep this one last.
+        counter_count
+    };
+
+#if defined ZMQ_HAVE_COUNTERS
+
+    //  Adds 'value_' to the counter.
+    ZMQ_EXPORT void counter_add (counter_id_t id_, uint32_t value_);
+
+    //  Subtracts 'value_' from the counter.
+    ZMQ_EXPORT void counter_sub (counter_id_t id_, uint32_t value_);
+
+#else
+
+    inline void counter_add (counter_id_t, uint32_t)
+    {
+    }
+
+    inline void counter_sub (counter_id_t, uint32_t)
+    {
+    }
+
+#endif
+
+    //  Returns current value of the counter.
+    ZMQ_EXPORT uint32_t counter_get (counter_id_t id_);
+
+}
+
+#endif
@@ -45,7 +45,9 @@ namespace zmq
         inline decoder_t () :
             read_ptr (NULL),
             to_read (0),
-            next (NULL)
+            next (NULL),
+            available_data (NULL),
+            available_size (0)
         {
         }
 
@@ -62,9 +64,12 @@ namespace zmq
                 }
                 pos += to_copy;
                 to_read -= to_copy;
-                while (!to_read)
+                while (!to_read) {
+                    available_data = data_ + pos;
+                    available_size = size_ - pos;
                     if (!(static_cast <T*> (this)->*next) ())
                         return pos;
+                }
                 if (pos == size_)
                     return pos;
             }
@@ -86,12 +91,25 @@ namespace zmq
             next = next_;
         }
 
+        //  Can be called from a state machine action. If next 'size_' bytes
+        //  are already present in the data being parsed, returns pointer
+        //  to them. Otherwise returns NULL. To skip the bytes once they are
+        //  processed in place, schedule next step with NULL 'read_ptr_'.
+        inline unsigned char *in_place (size_t size_)
+        {
+            return available_size >= size_ ? available_data : NULL;
+        }
+
     private:
 
         unsigned char *read_ptr;
         size_t to_read;
         step_t next;
 
+        //  Unparsed data at the moment the state machine action is invoked.
+        unsigned char *available_data;
+        size_t available_size;
+
         decoder_t (const decoder_t&);
         void operator = (const decoder_t&);
     };
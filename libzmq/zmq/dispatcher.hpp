@@ -31,9 +31,11 @@
 #include <zmq/i_thread.hpp>
 #include <zmq/i_signaler.hpp>
 #include <zmq/ypipe.hpp>
+#include <zmq/atomic_ptr.hpp>
 #include <zmq/mutex.hpp>
 #include <zmq/config.hpp>
 #include <zmq/scope.hpp>
+#include <zmq/message_pool.hpp>
 
 namespace zmq
 {
@@ -54,8 +56,12 @@ namespace zmq
     public:
 
         //  Create the dispatcher object. The actual number of threads
-        //  supported is determined by 'thread_count'.
-        ZMQ_EXPORT dispatcher_t (int thread_count_);
+        //  supported is determined by 'thread_count'. If 'message_pool' is
+        //  true, threads registered with the dispatcher allocate message
+        //  contents from a message pool rather than using malloc/free. In
+        //  such case, all the messages have to be deallocated before the
+        //  dispatcher is destroyed.
+        ZMQ_EXPORT dispatcher_t (int thread_count_, bool message_pool_ = false);
 
         //  Destroy the dispatcher object.
         ZMQ_EXPORT ~dispatcher_t ();
@@ -70,10 +76,15 @@ namespace zmq
         inline void write (int source_thread_id_, 
             int destination_thread_id_, const command_t &value_)
         {
-            command_pipe_t &pipe = pipes [source_thread_id_ *
-                  thread_count + destination_thread_id_];
-            pipe.write (value_);
-            if (!pipe.flush ())
+            command_pipe_t *pipe = NULL;
+            pipe_slot_t *row = rows [source_thread_id_].get ();
+            if (row)
+                pipe = row [destination_thread_id_].get ();
+            if (!pipe)
+                pipe = create_pipe (source_thread_id_, destination_thread_id_);
+
+            pipe->write (value_);
+            if (!pipe->flush ())
                 signalers [destination_thread_id_]->signal (source_thread_id_);
         }
 
@@ -82,8 +93,20 @@ namespace zmq
         inline bool read (int source_thread_id_, 
             int destination_thread_id_, command_t *command_)
         {
-            return pipes [source_thread_id_ * thread_count +
-                destination_thread_id_].read (command_);
+            pipe_slot_t *row = rows [source_thread_id_].get ();
+            if (!row)
+                return false;
+            command_pipe_t *pipe = row [destination_thread_id_].get ();
+            if (!pipe)
+                return false;
+            return pipe->read (command_);
+        }
+
+        //  Returns the message pool used by threads registered with the
+        //  dispatcher. NULL if message pooling is not used.
+        inline message_pool_t *get_message_pool ()
+        {
+            return message_pool;
         }
 
         //  Assign an thread ID to the caller. Register the supplied signaler
@@ -111,11 +134,27 @@ namespace zmq
         typedef ypipe_t <command_t, true,
             command_pipe_granularity> command_pipe_t;
 
+        //  Slot for a command pipe in the matrix.
+        typedef atomic_ptr_t <command_pipe_t> pipe_slot_t;
+
+        //  Creates the command pipe between the two threads, unless it was
+        //  already created by another thread in the meantime. Returns the
+        //  pipe.
+        ZMQ_EXPORT command_pipe_t *create_pipe (int source_thread_id_,
+            int destination_thread_id_);
+
         //  Number of threads dispatcher is preconfigured for.
         int thread_count;
 
-        //  NxN matrix of command pipes.
-        command_pipe_t *pipes;
+        //  NxN matrix of command pipes. Rows (one per source thread) as well
+        //  as pipes are allocated when the first command is written, so
+        //  only the pairs of threads actually communicating consume memory.
+        //  Command pipes are padded to cache line size (see ypipe_t), so no
+        //  two pipes share a cache line.
+        atomic_ptr_t <pipe_slot_t> *rows;
+
+        //  Message pool to be used by the threads. NULL if switched off.
+        message_pool_t *message_pool;
 
         //  Signalers to wake up individual threads.
         std::vector <i_signaler*> signalers;
@@ -25,6 +25,9 @@
 #include <string.h>
 #include <algorithm>
 
+#include <zmq/config.hpp>
+#include <zmq/io_vector.hpp>
+
 namespace zmq
 {
 
@@ -78,6 +81,67 @@ namespace zmq
 
             return pos;
         }
+
+        //  Same as above, however, the data are described by 'iov_' array
+        //  (up to 'iov_count_' items) rather than being copied into the chunk
+        //  as a whole. Data blocks at least zero_copy_threshold bytes long are
+        //  referenced directly, the rest is copied into the chunk. Returns
+        //  number of items filled in 'iov_'. The referenced data remain valid
+        //  till the next call to the function. To make that possible derived
+        //  class has to implement 'hold' function (keep the data of the current
+        //  step untouched) and 'release' function (drop all the held data).
+        inline int read_iov (unsigned char *data_, size_t size_,
+            io_vector_t *iov_, int iov_count_)
+        {
+            //  The data from the previous call are not needed anymore.
+            static_cast <T*> (this)->release ();
+
+            int count = 0;
+            size_t pos = 0;
+
+            while (true) {
+                if (to_write >= zero_copy_threshold) {
+
+                    //  Reference the data block directly.
+                    if (count == iov_count_)
+                        break;
+                    iov_ [count].data = write_pos;
+                    iov_ [count].size = to_write;
+                    count ++;
+                    write_pos += to_write;
+                    to_write = 0;
+                    static_cast <T*> (this)->hold ();
+                }
+                else if (to_write) {
+
+                    //  Copy the data block into the chunk. If the previous item
+                    //  refers to the chunk as well, just extend it.
+                    if (pos == size_)
+                        break;
+                    if (!count || iov_ [count - 1].data +
+                          iov_ [count - 1].size != data_ + pos) {
+                        if (count == iov_count_)
+                            break;
+                        iov_ [count].data = data_ + pos;
+                        iov_ [count].size = 0;
+                        count ++;
+                    }
+                    size_t to_copy = std::min (to_write, size_ - pos);
+                    memcpy (data_ + pos, write_pos, to_copy);
+                    pos += to_copy;
+                    write_pos += to_copy;
+                    to_write -= to_copy;
+                    iov_ [count - 1].size += to_copy;
+                }
+                else {
+                    if (!(static_cast <T*> (this)->*next) ())
+                        break;
+                }
+            }
+
+            return count;
+        }
+
     protected:
 
         //  Prototype of state machine action.
@@ -27,6 +27,7 @@
 #include <zmq/i_demux.hpp>
 #include <zmq/publisher.hpp>
 #include <zmq/load_balancer.hpp>
+#include <zmq/style.hpp>
 
 namespace zmq
 {
@@ -35,12 +36,12 @@ namespace zmq
     {
     protected:
 
-        engine_base_t (bool load_balancing_ = false)
+        engine_base_t (style_t style_ = style_data_distribution)
         {
-            if (load_balancing_)
-                demux = new load_balancer_t ();
-            else
+            if (style_ == style_data_distribution)
                 demux = new publisher_t ();
+            else
+                demux = new load_balancer_t (style_);
             assert (demux);
         }
 
@@ -56,12 +57,20 @@ namespace zmq
             return NULL;
         }
 
+        void get_pipes (std::vector <pipe_t*> &pipes_)
+        {
+            if (HAS_OUT)
+                mux.get_pipes (pipes_);
+            if (HAS_IN)
+                demux->get_pipes (pipes_);
+        }
+
         void revive (pipe_t *pipe_)
         {
             //  Notify the reader of the pipe that there are messages
             //  available in the pipe.
             assert (HAS_OUT);
-            pipe_->revive ();
+            mux.revive (pipe_);
         }
 
         void head (pipe_t *pipe_, int64_t position_)
@@ -0,0 +1,67 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __ZMQ_ENGINE_OPTIONS_HPP_INCLUDED__
+#define __ZMQ_ENGINE_OPTIONS_HPP_INCLUDED__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <zmq/stdint.hpp>
+
+namespace zmq
+{
+
+    //  Parser for the engine options string passed to 'bind'. The string
+    //  is a space-separated list of name=value pairs, e.g.
+    //  "zero_copy_in=1 in_batch_max=65536 subscribe=NYSE.". Values are
+    //  either integers or strings; an option can be specified several
+    //  times. Options not recognised by a particular engine are ignored.
+
+    class engine_options_t
+    {
+    public:
+
+        engine_options_t (const char *options_);
+
+        //  Returns value of the option or 'default_' if the option was not
+        //  specified.
+        int64_t get (const char *name_, int64_t default_) const;
+
+        //  Appends all the values specified for the option to 'values_'.
+        void get_all (const char *name_,
+            std::vector <std::string> &values_) const;
+
+    private:
+
+        typedef std::map <std::string, int64_t> options_t;
+        options_t options;
+
+        //  All the options as specified, including the non-numeric ones.
+        typedef std::multimap <std::string, std::string> strings_t;
+        strings_t strings;
+
+        engine_options_t (const engine_options_t&);
+        void operator = (const engine_options_t&);
+    };
+
+}
+
+#endif
@@ -29,6 +29,7 @@
 
 #include <zmq/poller.hpp>
 #include <zmq/fd.hpp>
+#include <zmq/stdint.hpp>
 
 namespace zmq
 {
@@ -36,6 +37,13 @@ namespace zmq
     //  Implements socket polling mechanism using the Linux-specific
     //  epoll mechanism. The class is used when  instantiating the poller
     //  template to generate the epoll_thread_t class.
+    //
+    //  Changes of the polling set are not passed to the kernel immediately.
+    //  Instead they are accumulated and applied once per loop iteration
+    //  so that an event that is switched on and off again doesn't cost
+    //  any system calls. Descriptors switched to edge-triggered mode are
+    //  registered for both input and output once and for all; engine's
+    //  interest is then only checked when delivering the events.
 
     class epoll_t
     {
@@ -50,7 +58,8 @@ namespace zmq
         void reset_pollin (handle_t handle_);
         void set_pollout (handle_t handle_);
         void reset_pollout (handle_t handle_);
-        bool process_events (poller_t <epoll_t> *poller_, bool timers_);
+        void set_edge_triggered (handle_t handle_);
+        bool process_events (poller_t <epoll_t> *poller_, int timeout_);
 
     private:
 
@@ -60,13 +69,53 @@ namespace zmq
         struct poll_entry_t
         {
             fd_t fd;
+
+            //  Events as currently registered with epoll.
             epoll_event ev;
+
+            //  Events the engine is interested in.
+            uint32_t events;
+
+            //  Events to be delivered to the engine without waiting for
+            //  epoll. Used in edge-triggered mode only.
+            uint32_t ready;
+
+            //  True if the entry is in the 'ready' list.
+            bool is_ready;
+
+            //  True if the entry is in the 'changed' list.
+            bool is_changed;
+
+            bool edge_triggered;
             i_pollable *engine;
         };
 
+        typedef std::vector <poll_entry_t*> entries_t;
+
+        //  Marks the entry as needing the update of the registered events.
+        void mark_changed (poll_entry_t *pe_);
+
+        //  Schedules delivery of 'events_' to the engine.
+        void mark_ready (poll_entry_t *pe_, uint32_t events_);
+
+        //  Passes the accumulated changes of the polling set to the kernel.
+        void apply_changes ();
+
+        //  Delivers the scheduled events to the engines. Returns true if
+        //  the thread should terminate.
+        bool process_ready (poller_t <epoll_t> *poller_);
+
+        //  Removes retired entries from the list.
+        static void remove_retired (entries_t &entries_);
+
+        //  List of entries with changed events.
+        entries_t changed;
+
+        //  List of entries with events to be delivered.
+        entries_t ready;
+
         //  List of retired event sources.
-        typedef std::vector <poll_entry_t*> retired_t;
-        retired_t retired;
+        entries_t retired;
 
         epoll_t (const epoll_t&);
         void operator = (const epoll_t&);
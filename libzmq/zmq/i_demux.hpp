@@ -20,6 +20,8 @@
 #ifndef __ZMQ_I_DEMUX_HPP_INCLUDED__
 #define __ZMQ_I_DEMUX_HPP_INCLUDED__
 
+#include <vector>
+
 #include <zmq/message.hpp>
 #include <zmq/pipe.hpp>
 
@@ -47,6 +49,12 @@ namespace zmq
         //  is returned.
         virtual bool write (message_t &msg_) = 0;
 
+        //  Distributes up to 'count_' messages from the 'msgs_' array in one
+        //  pass. Writing stops at the first message that cannot be sent.
+        //  Messages that were sent are cleared. Returns number of messages
+        //  sent.
+        virtual size_t write_many (message_t *msgs_, size_t count_) = 0;
+
         //  Flushes all messages.
         virtual void flush () = 0;
 
@@ -59,6 +67,9 @@ namespace zmq
         //  Stops sending messages to this pipe.
         virtual void release_pipe (pipe_t *pipe_) = 0;
 
+        //  Appends all the attached pipes to 'pipes_'.
+        virtual void get_pipes (std::vector <pipe_t*> &pipes_) = 0;
+
         //  Initiates shutdown of all attached pipes.
         virtual void initialise_shutdown () = 0;
 
@@ -20,6 +20,8 @@
 #ifndef __ZMQ_I_ENGINE_HPP_INCLUDED__
 #define __ZMQ_I_ENGINE_HPP_INCLUDED__
 
+#include <vector>
+
 #include <zmq/stdint.hpp>
 #include <zmq/command.hpp>
 
@@ -50,6 +52,9 @@ namespace zmq
         //  management of configuration.
         virtual const char *get_arguments () = 0;
 
+        //  Appends all the pipes the engine is attached to to 'pipes_'.
+        virtual void get_pipes (std::vector <class pipe_t*> &pipes_) = 0;
+
         //  Inter-thread commands.
         virtual void revive (class pipe_t *pipe_) = 0;
         virtual void head (class pipe_t *pipe_, int64_t position_) = 0;
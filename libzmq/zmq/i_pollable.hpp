@@ -47,6 +47,13 @@ namespace zmq
         //  Called by poll thread when unregistering the engine.
         virtual void unregister_event () = 0;
 
+        //  Called by I/O thread when the engine is about to be moved to
+        //  a different I/O thread. Engine stops polling without closing
+        //  its connection; it is registered with the new thread afterwards
+        //  using register_event. Returns false if the engine cannot be moved
+        //  at the moment, in which case nothing is changed.
+        virtual bool detach_event () = 0;
+
     };
 
 }
@@ -58,13 +58,25 @@ namespace zmq
         //  Stop polling for availability of the socket for writing.
         virtual void reset_pollout (handle_t handle_) = 0;
 
-        //  Ask to be notified after some time. Actual interval varies between
-        //  0 and max_timer_period ms. Timer is destroyed once it expires or,
-        //  optionally, when cancel_timer is called.
-        virtual void add_timer (struct i_pollable *engine_) = 0;
-
-        //  Cancel the timer set by add_timer method.
-        virtual void cancel_timer (struct i_pollable *engine_) = 0;
+        //  Ask to be notified only about changes of the socket state rather
+        //  than about the state itself. After each in_event (out_event)
+        //  engine has to read (write) until the operation would block.
+        //  If it stops earlier it has to call set_pollin (set_pollout)
+        //  anew to get notified once more. Calling set_pollin or
+        //  set_pollout always results in a notification in this mode.
+        //  Pollers that don't support the mode ignore the call.
+        virtual void set_edge_triggered (handle_t handle_) = 0;
+
+        //  Ask to be notified (via timer_event) once 'timeout_' milliseconds
+        //  elapse. Engine can have several timers running. Timer is destroyed
+        //  once it expires or when cancel_timer is called. Returns handle
+        //  representing the timer.
+        virtual handle_t add_timer (struct i_pollable *engine_,
+            int timeout_) = 0;
+
+        //  Cancel the timer identified by handle. The timer must not have
+        //  expired yet.
+        virtual void cancel_timer (handle_t handle_) = 0;
     };
 
 }
@@ -20,19 +20,48 @@
 #ifndef __ZMQ_IN_ENGINE_HPP_INCLUDED__
 #define __ZMQ_IN_ENGINE_HPP_INCLUDED__
 
+#include <map>
+#include <deque>
+#include <string>
+
 #include <zmq/engine_base.hpp>
+#include <zmq/raw_message.hpp>
 
 namespace zmq
 {
 
+    //  Engine representing a queue. If 'conflate_size_' is non-zero,
+    //  the first 'conflate_size_' bytes of a message are its key and
+    //  a message replaces the message with the same key that haven't
+    //  been read yet. The message takes the position of the replaced one.
+    //  Messages shorter than the key and notifications are never replaced.
+    //  The number of such messages held by the queue is limited by its high
+    //  water mark.
+
     class in_engine_t : public engine_base_t <false, true>
     {
     public:
 
         static in_engine_t *create (int64_t hwm_, int64_t lwm_,
-            uint64_t swap_size_);
+            uint64_t swap_size_, size_t conflate_size_ = 0);
 
         bool read (message_t *msg_);
+        size_t read_batch (message_t *msgs_, size_t max_);
+
+        //  Returns true if there may be messages available in the queue.
+        bool ready ();
+
+        //  Position of the queue in the owning API thread's list of queues.
+        //  Used exclusively by the API thread.
+        inline void set_index (size_t index_)
+        {
+            index = index_;
+        }
+
+        inline size_t get_index ()
+        {
+            return index;
+        }
 
         //  i_engine implementation.
         void get_watermarks (int64_t *hwm_, int64_t *lwm_);
@@ -40,12 +69,37 @@ namespace zmq
 
     private:
 
-        in_engine_t (int64_t hwm_, int64_t lwm_, int64_t swap_size_);
+        in_engine_t (int64_t hwm_, int64_t lwm_, int64_t swap_size_,
+            size_t conflate_size_);
         ~in_engine_t ();
 
+        //  Moves the messages available in the pipes to the conflation
+        //  buffer, replacing the messages with the same keys.
+        void conflate ();
+
         int64_t hwm;
         int64_t lwm;
         int64_t swap_size;
+
+        //  Size of the message key, zero if the queue doesn't conflate
+        //  messages.
+        size_t conflate_size;
+
+        //  Messages waiting to be read from the conflating queue. Message
+        //  number N (counting since the queue was created) is stored at
+        //  position N - 'head' of the buffer.
+        std::deque <raw_message_t> buffer;
+        uint64_t head;
+
+        //  Number of buffered messages that are never replaced.
+        uint64_t unkeyed;
+
+        //  Numbers of the buffered messages by their keys.
+        typedef std::map <std::string, uint64_t> keys_t;
+        keys_t keys;
+
+        //  Position of the queue in the API thread's list of queues.
+        size_t index;
     };
 
 }
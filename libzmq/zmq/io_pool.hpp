@@ -0,0 +1,98 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __ZMQ_IO_POOL_HPP_INCLUDED__
+#define __ZMQ_IO_POOL_HPP_INCLUDED__
+
+#include <zmq/export.hpp>
+#include <zmq/stdint.hpp>
+#include <zmq/config.hpp>
+#include <zmq/i_thread.hpp>
+#include <zmq/atomic_ptr.hpp>
+#include <zmq/atomic_counter.hpp>
+
+namespace zmq
+{
+
+    //  Group of I/O threads sharing the load. Each member thread measures
+    //  the number of events generated by each of its engines and publishes
+    //  the overall number once in io_pool_window milliseconds. If a thread
+    //  is much busier than the least loaded member of the pool, it moves
+    //  one of its engines to that thread. Thus a single hot connection
+    //  doesn't leave the other threads idle while there are other
+    //  connections competing with it for its thread. Only engines created
+    //  by listeners can be moved (see i_pollable::detach_event).
+    //
+    //  Pool is passed to the 'create' function of I/O threads. It has to
+    //  exist as long as its member threads.
+
+    class io_pool_t
+    {
+    public:
+
+        //  Creates a pool for up to 'thread_count_' I/O threads.
+        ZMQ_EXPORT io_pool_t (int thread_count_);
+        ZMQ_EXPORT ~io_pool_t ();
+
+        //  Following functions are used by the I/O threads in the pool.
+
+        //  Adds the thread to the pool. Returns index of the thread within
+        //  the pool.
+        ZMQ_EXPORT int join (i_thread *thread_);
+
+        //  Publishes the load of the thread measured over the last window.
+        ZMQ_EXPORT void set_load (int index_, uint32_t load_);
+
+        //  Adds to the published load of the thread. Used when an engine is
+        //  moved to the thread so that other threads take it into account
+        //  before the thread publishes the load itself.
+        ZMQ_EXPORT void add_load (int index_, uint32_t load_);
+
+        //  Returns index of the least loaded thread of the pool other than
+        //  the thread 'index_' and stores its load in 'load_'. Returns -1
+        //  if there's no other thread in the pool.
+        ZMQ_EXPORT int get_least_loaded (int index_, uint32_t *load_);
+
+        //  Returns the thread with the specified index.
+        ZMQ_EXPORT i_thread *get_thread (int index_);
+
+    private:
+
+        struct member_t
+        {
+            atomic_ptr_t <i_thread> thread;
+            atomic_counter_t load;
+            unsigned char pad [cache_line_size];
+        };
+
+        //  Members of the pool. The array is allocated in advance so that
+        //  threads can join the pool while others are reading it.
+        member_t *members;
+        int thread_count;
+
+        //  Number of threads that have joined so far.
+        atomic_counter_t joined;
+
+        io_pool_t (const io_pool_t&);
+        void operator = (const io_pool_t&);
+    };
+
+}
+
+#endif
@@ -48,7 +48,8 @@ namespace zmq
         void reset_pollin (handle_t handle_);
         void set_pollout (handle_t handle_);
         void reset_pollout (handle_t handle_);
-        bool process_events (poller_t <kqueue_t> *poller_, bool timers_);
+        void set_edge_triggered (handle_t handle_);
+        bool process_events (poller_t <kqueue_t> *poller_, int timeout_);
 
     private:
 
@@ -23,26 +23,34 @@
 #include <vector>
 
 #include <zmq/i_demux.hpp>
+#include <zmq/stdint.hpp>
+#include <zmq/style.hpp>
 
 namespace zmq
 {
 
-    //  Object to distribute messages to outbound pipes.
+    //  Object to distribute messages to outbound pipes. Each message is sent
+    //  to a single pipe. With style_load_balancing the pipes are chosen in
+    //  round-robin fashion. With style_least_loaded the pipe with the fewest
+    //  queued messages (see pipe_t::get_queued) is chosen, style_two_choices
+    //  chooses the less loaded one of two random pipes.
 
     class load_balancer_t : public i_demux
     {
     public:
 
-        load_balancer_t ();
+        load_balancer_t (style_t style_ = style_load_balancing);
 
         //  i_demux interface implementation.
         ~load_balancer_t ();
         void send_to (pipe_t *pipe_);
         bool write (message_t &msg_);
+        size_t write_many (message_t *msgs_, size_t count_);
         void flush ();
         void gap ();
         bool empty ();
         void release_pipe (pipe_t *pipe_);
+        void get_pipes (std::vector <pipe_t*> &pipes_);
         void initialise_shutdown ();
 
     private:
@@ -54,6 +62,18 @@ namespace zmq
         //  Index of the pipe that will receive next message.
         unsigned current;
 
+        //  Algorithm used to choose the pipe.
+        style_t style;
+
+        //  State of the random number generator used by style_two_choices.
+        uint32_t seed;
+
+        //  Sets 'current' to the pipe the message should be sent to.
+        //  Returns false if no pipe is ready to accept the message.
+        bool choose_round_robin ();
+        bool choose_least_loaded ();
+        bool choose_two_choices ();
+
         load_balancer_t (const load_balancer_t&);
         void operator = (const load_balancer_t&);
     };
@@ -0,0 +1,143 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef __ZMQ_MESSAGE_POOL_HPP_INCLUDED__
+#define __ZMQ_MESSAGE_POOL_HPP_INCLUDED__
+
+#include <stddef.h>
+#include <vector>
+
+#include <zmq/platform.hpp>
+#include <zmq/config.hpp>
+#include <zmq/atomic_ptr.hpp>
+#include <zmq/mutex.hpp>
+#include <zmq/export.hpp>
+
+//  Message pooling requires thread-local storage. The pointer to the message
+//  cache of the current thread is accessed from inline functions in user
+//  code, so the pooling is available only where thread-local variables
+//  can be exported from a shared library.
+#if defined __GNUC__ && !defined ZMQ_HAVE_WINDOWS
+#define ZMQ_HAVE_MESSAGE_POOL
+#endif
+
+namespace zmq
+{
+
+    struct message_content_t;
+
+    //  Per-thread cache of memory blocks for message contents. Blocks are
+    //  sorted into size classes (powers of two from message_pool_min_size
+    //  to message_pool_max_size). Blocks are allocated and returned by the
+    //  owner thread without any synchronisation. Blocks deallocated by other
+    //  threads are pushed to a lock-free list, which is taken over by the
+    //  owner thread in one atomic operation once its local list runs dry.
+
+    class message_cache_t
+    {
+    public:
+
+        message_cache_t ();
+        ~message_cache_t ();
+
+        //  Allocates a block for message content and 'size_' bytes of
+        //  message data. Returns NULL if the size is beyond the pooled size
+        //  classes. The block has to be initialised by the caller.
+        ZMQ_EXPORT message_content_t *allocate (size_t size_);
+
+        //  Returns the block to the cache it was allocated from. Can be
+        //  called from any thread.
+        ZMQ_EXPORT static void deallocate (message_content_t *content_);
+
+#if defined ZMQ_HAVE_MESSAGE_POOL
+        //  Message cache of the current thread. NULL if the thread doesn't
+        //  use message pooling.
+        ZMQ_EXPORT static __thread message_cache_t *current;
+#endif
+
+    private:
+
+        enum {class_count = message_pool_class_count};
+
+        //  Block of memory on a free list.
+        struct block_t
+        {
+            block_t *next;
+        };
+
+        //  Returns size class for the specified data size.
+        static int get_class (size_t size_);
+
+        //  Frees all the blocks in the list.
+        static void free_list (block_t *list_);
+
+        //  Lists of free blocks, accessed exclusively by the owner thread.
+        block_t *local [class_count];
+        int local_size [class_count];
+
+        //  Lists of blocks returned by other threads.
+        atomic_ptr_t <block_t> remote [class_count];
+
+        message_cache_t (const message_cache_t&);
+        void operator = (const message_cache_t&);
+    };
+
+    //  Message pool holds message caches for all the threads registered
+    //  with the dispatcher the pool belongs to. Note that when pooling is
+    //  used all the messages have to be deallocated before the pool (i.e.
+    //  the dispatcher) is destroyed. Application threads other than the one
+    //  destroying the pool have to destroy their API threads beforehand so
+    //  that they are detached from the pool.
+
+    class message_pool_t
+    {
+    public:
+
+        message_pool_t ();
+        ~message_pool_t ();
+
+        //  Makes a message cache the calling thread's current message cache
+        //  and returns it. Cache left behind by a detached thread is reused
+        //  if available, otherwise a new one is created.
+        message_cache_t *attach ();
+
+        //  The calling thread stops using the message cache returned by
+        //  attach. The cache is handed over to the next thread that attaches.
+        //  Till then, it is kept alive so that the messages allocated from it
+        //  can still be deallocated.
+        void detach (message_cache_t *cache_);
+
+    private:
+
+        //  All the caches created by the pool.
+        typedef std::vector <message_cache_t*> caches_t;
+        caches_t caches;
+
+        //  Caches not used by any thread at the moment.
+        caches_t unused;
+
+        //  Synchronises access to the lists of caches.
+        mutex_t sync;
+
+        message_pool_t (const message_pool_t&);
+        void operator = (const message_pool_t&);
+    };
+
+}
+
+#endif
@@ -23,6 +23,7 @@
 #include <assert.h>
 #include <vector>
 
+#include <zmq/stdint.hpp>
 #include <zmq/message.hpp>
 #include <zmq/pipe.hpp>
 
@@ -30,6 +31,22 @@ namespace zmq
 {
 
     //  Object to aggregate messages from inbound pipes.
+    //
+    //  Only the pipes that may contain messages are visited when reading.
+    //  Pipe that turns out to be empty is set aside until it is revived
+    //  by the writer, so the cost of reading doesn't depend on the number
+    //  of idle pipes.
+    //
+    //  Pipes are grouped by their priority (see pipe_t::set_scheduling).
+    //  Messages are read from a lower priority pipe only if there are no
+    //  messages in the higher priority pipes. Pipes of the same priority
+    //  are read in round-robin fashion. By default each pipe passes a
+    //  single message per round. Pipe with a weight passes messages
+    //  totalling up to 'weight' bytes per round instead (deficit round
+    //  robin), so that bandwidth is shared in proportion to the weights.
+    //  Pipes that have no share left are replenished all at once, so
+    //  the cost of reading doesn't depend on the ratio of message size
+    //  to the weight.
 
     class mux_t
     {
@@ -41,27 +58,100 @@ namespace zmq
         //  Adds a pipe to receive messages from.
         void receive_from (pipe_t *pipe_);
 
+        //  Makes the dead pipe alive once more and schedules it for reading.
+        void revive (pipe_t *pipe_);
+
+        //  Returns true if there are pipes that may contain messages.
+        bool ready ();
+
         //  Returns a message, if available. If not, returns false.
         bool read (message_t *msg_);
 
+        //  Fills the 'msgs_' array with up to 'max_' messages. Pipes are
+        //  visited in the same order as in 'read', however, all the messages
+        //  prefetched from a pipe without weight are retrieved at once.
+        //  Returns number of messages retrieved. Unused array elements are
+        //  set to be 0-byte messages.
+        size_t read_batch (message_t *msgs_, size_t max_);
+
         //  Returns true if there are no pipes attached.
         bool empty ();
 
         //  Drop references to the specified pipe.
         void release_pipe (pipe_t *pipe_);
 
+        //  Appends all the attached pipes to 'pipes_'.
+        void get_pipes (std::vector <pipe_t*> &pipes_);
+
         //  Initiate shutdown of all associated pipes.
         void initialise_shutdown ();
 
     private:
 
-        //  The list of inbound pipes.
-        typedef std::vector <pipe_t*> pipes_t;
-        pipes_t pipes;
-
-        //  Pipe to retrieve next message from. The messages are retrieved
-        //  from the pipes in round-robin fashion (a.k.a. fair queueing).
-        pipes_t::size_type current;
+        //  Inbound pipe and its deficit round robin state. If 'weight' is
+        //  zero, the pipe passes a single message per round and 'deficit'
+        //  is not used. Otherwise 'deficit' is the number of bytes the pipe
+        //  can still pass in the current round. If 'active' is true, 'prev'
+        //  and 'next' are the neighbours of the pipe in the ring of active
+        //  pipes.
+        struct entry_t
+        {
+            pipe_t *pipe;
+            int64_t weight;
+            int64_t deficit;
+            bool active;
+            size_t prev;
+            size_t next;
+        };
+        typedef std::vector <entry_t> entries_t;
+
+        //  Pipes of the same priority. Active pipes, i.e. those that may
+        //  contain messages, are linked into a ring in the order they became
+        //  active. The rest of the pipes are dead. The messages are retrieved
+        //  from the active pipes in round-robin fashion (a.k.a. fair
+        //  queueing), 'current' being the pipe to retrieve next message from.
+        //  Pipe is added to and removed from the ring in constant time
+        //  without changing the order of the other pipes. 'skipped' is
+        //  the number of weighted pipes visited in a row that had no share
+        //  left.
+        struct class_t
+        {
+            int priority;
+            entries_t pipes;
+            entries_t::size_type active;
+            entries_t::size_type current;
+            entries_t::size_type skipped;
+        };
+
+        //  Classes of pipes ordered by descending priority. In most cases
+        //  there's a single class.
+        typedef std::vector <class_t> classes_t;
+        classes_t classes;
+
+        //  None of the classes preceding 'top' has active pipes.
+        classes_t::size_type top;
+
+        //  Returns position of the class of pipes with the specified
+        //  priority. If there's no such class, it is created.
+        classes_t::size_type get_class (int priority_);
+
+        //  Links the pipe into the ring of active pipes of the class so that
+        //  it is visited last in the current round.
+        void activate (class_t &class_, size_t index_);
+
+        //  Unlinks the pipe from the ring of active pipes of the class.
+        //  If it is the current pipe, the next one becomes current.
+        void deactivate (class_t &class_, size_t index_);
+
+        //  Moves to the next pipe of the class.
+        void advance (class_t &class_);
+
+        //  Charges the weighted pipe for the message it has passed.
+        void charge (entry_t &entry_, raw_message_t *msg_);
+
+        //  Passes the turn of the weighted pipe with no share left
+        //  to the next pipe.
+        void skip (class_t &class_, entry_t &entry_);
 
         mux_t (const mux_t&);
         void operator = (const mux_t&);
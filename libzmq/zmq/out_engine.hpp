@@ -21,6 +21,7 @@
 #define __ZMQ_OUT_ENGINE_HPP_INCLUDED__
 
 #include <zmq/engine_base.hpp>
+#include <zmq/style.hpp>
 
 namespace zmq
 {
@@ -29,9 +30,10 @@ namespace zmq
     {
     public:
 
-        static out_engine_t *create (bool load_balancing_);
+        static out_engine_t *create (style_t style_);
 
         bool write (message_t &msg_);
+        size_t write_many (message_t *msgs_, size_t count_);
         void flush ();
 
         //  i_engine implementation.
@@ -40,7 +42,7 @@ namespace zmq
 
     private:
 
-        out_engine_t (bool load_balancing_);
+        out_engine_t (style_t style_);
         ~out_engine_t ();
 
     };
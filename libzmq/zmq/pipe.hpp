@@ -20,6 +20,9 @@
 #ifndef __ZMQ_PIPE_HPP_INCLUDED__
 #define __ZMQ_PIPE_HPP_INCLUDED__
 
+#include <vector>
+#include <string>
+
 #include <zmq/stdint.hpp>
 #include <zmq/i_thread.hpp>
 #include <zmq/ypipe.hpp>
@@ -51,7 +54,19 @@ namespace zmq
         //  to the pipe.
         bool check_write ();
 
-        //  Write a message to the pipe.
+        //  Number of messages written to the pipe that the reader haven't
+        //  processed yet, as far as the writer knows. The reader reports
+        //  its position only if the pipe has limits (see 'read'), thus for
+        //  unlimited pipes this is the number of messages ever written.
+        inline uint64_t get_queued ()
+        {
+            return in_core_msg_cnt + in_swap_msg_cnt;
+        }
+
+        //  Write a message to the pipe. If the pipe is full and its overflow
+        //  policy is 'overflow_conflate', the message is stored and written
+        //  to the pipe once there's space available. Message stored
+        //  previously is dropped.
         void write (raw_message_t *msg_);
 
         //  Write gap notification to the pipe. This call cannot fail. If the
@@ -67,6 +82,10 @@ namespace zmq
         //  Reads a message from the pipe.
         bool read (raw_message_t *msg);
 
+        //  Reads up to 'max_' messages from the pipe in a single pass.
+        //  Returns number of messages actually read.
+        size_t read_batch (raw_message_t *msgs_, size_t max_);
+
         //  Make the dead pipe alive once more.
         void revive ();
 
@@ -85,6 +104,123 @@ namespace zmq
         //  Confirms pipe shut down to the reader.
         void reader_terminated ();
 
+        //  Returns true if the 'engine_' end of the pipe has initiated
+        //  the pipe shut down.
+        bool is_terminating (struct i_engine *engine_);
+
+        //  Returns the thread of the engine on the other side of the pipe
+        //  than 'engine_'.
+        i_thread *get_peer_thread (struct i_engine *engine_);
+
+        //  Moves the 'engine_' end of the pipe to the thread 'thread_'.
+        //  Returns the thread the end of the pipe was attached to so far.
+        //  Used by the thread on the other end of the pipe, so that
+        //  commands it sends to the engine are redirected in order.
+        i_thread *rehome (struct i_engine *engine_, i_thread *thread_);
+
+        //  Topics the reader is subscribed to. If there are none, the reader
+        //  gets all the messages. Topics have to be set before the pipe is
+        //  passed to the writer.
+        typedef std::vector <std::string> topics_t;
+        inline void set_topics (const topics_t &topics_)
+        {
+            topics = topics_;
+        }
+
+        inline const topics_t &get_topics ()
+        {
+            return topics;
+        }
+
+        //  Name of the queue the pipe leads to. Has to be set before
+        //  the pipe is passed to the writer.
+        inline void set_queue_name (const char *queue_name_)
+        {
+            queue_name = queue_name_;
+        }
+
+        inline const std::string &get_queue_name ()
+        {
+            return queue_name;
+        }
+
+        //  What the writer does with messages when the pipe is full.
+        //  'overflow_block' stalls the writer until there's space in
+        //  the pipe. 'overflow_drop' drops the messages and notifies the
+        //  reader about the gap. 'overflow_conflate' keeps only the latest
+        //  message and passes it to the reader once there's space available.
+        //  'overflow_disconnect' drops the messages the same way as
+        //  'overflow_drop', however, if the pipe stays full for 'timeout_'
+        //  milliseconds, the writer closes the pipe. Policy has to be set
+        //  before the pipe is passed to the writer.
+        enum overflow_t
+        {
+            overflow_block,
+            overflow_drop,
+            overflow_conflate,
+            overflow_disconnect
+        };
+
+        inline void set_overflow (overflow_t overflow_, uint64_t timeout_)
+        {
+            overflow = overflow_;
+            overflow_timeout = timeout_;
+        }
+
+        inline overflow_t get_overflow ()
+        {
+            return overflow;
+        }
+
+        //  Drops the message because the pipe is full. Gap notification
+        //  is sent to the reader.
+        void drop ();
+
+        //  Returns true if the pipe has been full for longer than
+        //  the disconnect timeout. 'now_' is the current time in ms.
+        bool overflow_expired (uint64_t now_);
+
+        //  Makes the pipe count the messages that haven't been written to
+        //  it because it was full in '*dropped_'. The counter is updated
+        //  exclusively by the writer thread.
+        inline void set_drop_counter (uint64_t *dropped_)
+        {
+            dropped = dropped_;
+        }
+
+        //  Position of the pipe in the reader's mux. Used exclusively by
+        //  the reader thread.
+        inline void set_index (size_t index_)
+        {
+            index = index_;
+        }
+
+        inline size_t get_index ()
+        {
+            return index;
+        }
+
+        //  Scheduling of the pipe in the reader's mux (see mux_t). Pipes
+        //  with higher priority are read first. Non-zero weight is
+        //  the number of bytes the pipe can pass in a single round, zero
+        //  means a single message per round. Both have to be set before
+        //  the pipe is passed to the reader.
+        inline void set_scheduling (int priority_, int64_t weight_)
+        {
+            priority = priority_;
+            weight = weight_;
+        }
+
+        inline int get_priority ()
+        {
+            return priority;
+        }
+
+        inline int64_t get_weight ()
+        {
+            return weight;
+        }
+
     private:
 
         //  The message pipe itself.
@@ -142,6 +278,33 @@ namespace zmq
         bool writer_terminating;
         bool reader_terminating;
 
+        //  Position of the pipe in the reader's mux.
+        size_t index;
+
+        //  Scheduling parameters of the pipe in the reader's mux.
+        int priority;
+        int64_t weight;
+
+        //  Topics the reader is subscribed to.
+        topics_t topics;
+
+        //  Name of the queue the pipe leads to.
+        std::string queue_name;
+
+        //  Overflow policy of the pipe and the disconnect timeout.
+        overflow_t overflow;
+        uint64_t overflow_timeout;
+
+        //  Time when the pipe was found full, zero if it is not full.
+        uint64_t full_since;
+
+        //  Latest message written to the conflating pipe while it was full.
+        bool conflated;
+        raw_message_t conflated_msg;
+
+        //  Where to count the dropped messages, NULL if nowhere.
+        uint64_t *dropped;
+
         pipe_t (const pipe_t&);
         void operator = (const pipe_t&);
 
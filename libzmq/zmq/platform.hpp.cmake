@@ -40,3 +40,9 @@
 
 /* Have OpenPGM */
 #cmakedefine ZMQ_HAVE_OPENPGM 1
+
+/* Total size of raw message structure */
+#cmakedefine ZMQ_MESSAGE_SIZE @ZMQ_MESSAGE_SIZE@
+
+/* Have performance counters */
+#cmakedefine ZMQ_HAVE_COUNTERS 1
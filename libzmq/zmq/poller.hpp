@@ -21,6 +21,7 @@
 #define __ZMQ_POLLER_HPP_INCLUDED__
 
 #include <vector>
+#include <map>
 #include <cstdlib>
 #include <algorithm>
 #include <signal.h>
@@ -31,6 +32,10 @@
 #include <zmq/ysocketpair.hpp>
 #include <zmq/thread.hpp>
 #include <zmq/fd.hpp>
+#include <zmq/config.hpp>
+#include <zmq/clock.hpp>
+#include <zmq/io_pool.hpp>
+#include <zmq/timer_wheel.hpp>
 
 namespace zmq
 {
@@ -46,7 +51,14 @@ namespace zmq
     {
     public:
 
-        static i_thread *create (dispatcher_t *dispatcher_);
+        //  Creates the I/O thread. If 'pool_' is supplied, the thread joins
+        //  the pool and shares the load with the other threads in the pool.
+        //  If 'affinity_' is non-zero the thread is pinned to the specified
+        //  CPUs (see thread_t::set_affinity). As the thread allocates its
+        //  message cache and the pipe chunks it reads from itself, they end
+        //  up on the NUMA node of those CPUs.
+        static i_thread *create (dispatcher_t *dispatcher_,
+            io_pool_t *pool_ = NULL, uint64_t affinity_ = 0);
         
         //  i_poller implementation.
         int get_thread_id ();
@@ -59,16 +71,16 @@ namespace zmq
         void reset_pollin (handle_t handle_);
         void set_pollout (handle_t handle_);
         void reset_pollout (handle_t handle_);
-        void add_timer (i_pollable *engine_);
-        void cancel_timer (i_pollable *engine_);
+        void set_edge_triggered (handle_t handle_);
+        handle_t add_timer (i_pollable *engine_, int timeout_);
+        void cancel_timer (handle_t handle_);
 
-        //  Callback functions called by event_monitor.
+        //  Callback function called by event_monitor.
         bool process_event (i_pollable *engine_, event_t event_);
-        void timer_event ();
 
     private:
 
-        poller_t (dispatcher_t *dispatcher_);
+        poller_t (dispatcher_t *dispatcher_, io_pool_t *pool_);
         ~poller_t ();
 
         //  Main worker thread routine.
@@ -77,10 +89,39 @@ namespace zmq
         //  Main routine (non-static) - called from worker_routine.
         void loop ();
 
+        //  Processes all the commands available. Returns true if the thread
+        //  should terminate. On return the thread is marked as parked, i.e.
+        //  the next command is going to wake it up via signaler.
+        bool process_commands ();
+
         //  Processes individual command. Returns false if the thread should
         //  terminate.
         bool process_command (const command_t &command_);
 
+        //  Publishes the load of the thread once per load measurement window
+        //  and moves an engine to a different thread of the pool if this
+        //  thread is overloaded.
+        void balance ();
+
+        //  Moves the engine to the thread of the pool with the specified
+        //  index. Returns false if the engine cannot be moved. See command_t
+        //  for the description of the hand-off protocol.
+        bool migrate (i_engine *engine_, int target_);
+
+        //  If the command is addressed to an engine being moved from or to
+        //  this thread, stores the command to be executed once the engine
+        //  is handed over and returns true.
+        bool hold_command (const command_t &command_);
+
+        //  Called on shut down. Engines that haven't been handed over yet
+        //  are registered with this thread so that they are unregistered
+        //  along with the others. These are the engines moved from this
+        //  thread that are still waiting for their pipes to be redirected
+        //  and those moved to this thread that were handed over already,
+        //  but the hand-off wasn't processed yet. The held commands are
+        //  dropped.
+        void finish_migrations ();
+
         //  Pointer to dispatcher.
         dispatcher_t *dispatcher;
 
@@ -100,26 +141,58 @@ namespace zmq
         //  We perform I/O multiplexing using event monitor.
         T event_monitor;
 
-        //  List of all the engines waiting for the timer event.
-        typedef std::vector <i_pollable*> timers_t;
-        timers_t timers;
+        //  Timers set by the engines.
+        timer_wheel_t timers;
 
         //  List of all registered engines.
         typedef std::vector <i_engine*> engines_t;
         engines_t engines;
+
+        //  Pool the thread belongs to (NULL if none) and index of the thread
+        //  within the pool.
+        io_pool_t *pool;
+        int pool_index;
+
+        //  Start of the current load measurement window (in milliseconds),
+        //  number of events and engine commands processed within the window
+        //  and their number per engine.
+        uint64_t window_start;
+        uint32_t window_load;
+        typedef std::map <i_pollable*, uint32_t> engine_loads_t;
+        engine_loads_t engine_loads;
+
+        //  Engine being moved between threads along with the commands
+        //  for the engine held till the hand-off is completed.
+        struct migration_t
+        {
+            i_engine *engine;
+
+            //  Thread the engine is moved to and number of pipes whose
+            //  redirection is yet to be confirmed. Used by the old thread.
+            i_thread *thread;
+            int pending_acks;
+
+            std::vector <command_t> *commands;
+        };
+        typedef std::vector <migration_t> migrations_t;
+
+        //  Engines being moved from and to this thread.
+        migrations_t emigrants;
+        migrations_t immigrants;
     };
 
 }
 
 template <class T>
-zmq::i_thread *zmq::poller_t <T>::create (dispatcher_t *dispatcher_)
+zmq::i_thread *zmq::poller_t <T>::create (dispatcher_t *dispatcher_,
+    io_pool_t *pool_, uint64_t affinity_)
 {
     //  Create the object.
-    poller_t <T> *poller = new poller_t <T> (dispatcher_);
+    poller_t <T> *poller = new poller_t <T> (dispatcher_, pool_);
     assert (poller);
 
     //  Start the thread.
-    poller->worker.start (worker_routine, poller);
+    poller->worker.start (worker_routine, poller, affinity_);
 
     return poller;
 }
@@ -135,14 +208,24 @@ void zmq::poller_t <T>::destroy ()
 }
 
 template <class T>
-zmq::poller_t <T>::poller_t (dispatcher_t *dispatcher_) :
-    dispatcher (dispatcher_)
+zmq::poller_t <T>::poller_t (dispatcher_t *dispatcher_, io_pool_t *pool_) :
+    dispatcher (dispatcher_),
+    pool (pool_),
+    pool_index (-1),
+    window_start (0),
+    window_load (0)
 {
     signaler_handle = event_monitor.add_fd (signaler.get_fd (), NULL);
     event_monitor.set_pollin (signaler_handle);
 
     //  Register the thread with command dispatcher.
     thread_id = dispatcher->allocate_thread_id (this, &signaler);
+
+    //  Join the pool.
+    if (pool) {
+        pool_index = pool->join (this);
+        window_start = clock_ms ();
+    }
 }
 
 template <class T>
@@ -216,18 +299,24 @@ void zmq::poller_t <T>::reset_pollout (handle_t handle_)
 }
 
 template <class T>
-void zmq::poller_t <T>::add_timer (i_pollable *engine_)
+void zmq::poller_t <T>::set_edge_triggered (handle_t handle_)
 {
-     timers.push_back (engine_);
+    event_monitor.set_edge_triggered (handle_);
 }
 
 template <class T>
-void zmq::poller_t <T>::cancel_timer (i_pollable *engine_)
+zmq::handle_t zmq::poller_t <T>::add_timer (i_pollable *engine_,
+    int timeout_)
 {
-    timers_t::iterator it = std::find (timers.begin (), timers.end (), engine_);
-    if (it == timers.end ())
-        return;
-    timers.erase (it);
+    handle_t handle;
+    handle.ptr = timers.add (engine_, clock_ms (), timeout_);
+    return handle;
+}
+
+template <class T>
+void zmq::poller_t <T>::cancel_timer (handle_t handle_)
+{
+    timers.cancel (handle_.ptr);
 }
 
 template <class T>
@@ -250,41 +339,61 @@ void zmq::poller_t <T>::loop ()
     errno_assert (rc == 0);
 #endif
 
-    //  Main event loop.
+    //  Use the message pool in this thread, if there's one.
+    message_pool_t *message_pool = dispatcher->get_message_pool ();
+    message_cache_t *message_cache = NULL;
+    if (message_pool)
+        message_cache = message_pool->attach ();
+
+    //  Main event loop. Commands are checked for before waiting for events
+    //  so that the signaler starts waking the thread up. The thread waits
+    //  till the nearest timer expires. Threads in a pool wake up at least
+    //  once in max_timer_period milliseconds so that they are able to
+    //  report their load.
     while (true) {
-        if (event_monitor.process_events (this, !timers.empty ()))
+        if (process_commands ())
            break;
+        int timeout = timers.empty () ? -1 : timers.timeout (clock_ms ());
+        if (pool && (timeout == -1 || timeout > max_timer_period))
+            timeout = max_timer_period;
+        if (event_monitor.process_events (this, timeout))
+           break;
+        if (!timers.empty ())
+            timers.execute (clock_ms ());
+        if (pool)
+            balance ();
     }
 
+    //  Engines being moved to or from this thread are not polled by any
+    //  thread. Make sure they are unregistered as well.
+    finish_migrations ();
+
     //  Unregister all the registered engines.
     for (engines_t::iterator it = engines.begin (); it != engines.end (); it ++)
         (*it)->cast_to_pollable ()->unregister_event ();
+
+    if (message_cache)
+        message_pool->detach (message_cache);
 }
 
 template <class T>
 bool zmq::poller_t <T>::process_event (i_pollable *engine_, event_t event_)
 {
     if (!engine_) {
-        ysocketpair_t::integer_t signals = signaler.check ();
-        assert (signals);
-
-        //  Iterate through all the threads in the process and find out
-        //  which of them sent us commands.
-        for (int source_thread_id = 0;
-              source_thread_id != dispatcher->get_thread_count ();
-              source_thread_id ++) {
-            if (signals & (ysocketpair_t::integer_t (1) << source_thread_id)) {
-
-                //  Read all the commands from particular thread.
-                command_t command;
-                while (dispatcher->read (source_thread_id, thread_id,
-                      &command))
-                    if (!process_command (command))
-                        return true;
-            }
-        }
+
+        //  Wake-up may be spurious. Signals may have been retrieved while
+        //  processing the previous wake-up.
+        signaler.reset ();
+        return process_commands ();
     }
     else {
+
+        //  Measure the load generated by individual engines.
+        if (pool) {
+            window_load ++;
+            engine_loads [engine_] ++;
+        }
+
         switch (event_) {
         case event_out:
             engine_->out_event ();
@@ -298,6 +407,36 @@ bool zmq::poller_t <T>::process_event (i_pollable *engine_, event_t event_)
     return false;
 }
 
+template <class T>
+bool zmq::poller_t <T>::process_commands ()
+{
+    int spins = 0;
+    while (true) {
+
+        //  Retrieve the signals. Spin for a while, if requested, before
+        //  parking the thread.
+        signals_t signals;
+        if (!signaler.check (signals, spins == io_thread_spin_count)) {
+            if (spins == io_thread_spin_count)
+                return false;
+            spins ++;
+            cpu_relax ();
+            continue;
+        }
+
+        //  Iterate through the threads that sent us commands.
+        int source_thread_id;
+        while ((source_thread_id = signals.pop ()) != -1) {
+
+            //  Read all the commands from particular thread.
+            command_t command;
+            while (dispatcher->read (source_thread_id, thread_id, &command))
+                if (!process_command (command))
+                    return true;
+        }
+    }
+}
+
 template <class T>
 bool zmq::poller_t <T>::process_command (const command_t &command_)
 {
@@ -326,11 +465,111 @@ bool zmq::poller_t <T>::process_command (const command_t &command_)
         engine->cast_to_pollable ()->unregister_event ();
         break;
 
+    //  Engine is being moved to this thread.
+    case command_t::adopt_engine:
+        {
+            //  Hold the commands for the engine till it is handed over.
+            engine = command_.args.adopt_engine.engine;
+            migration_t migration;
+            migration.engine = engine;
+            migration.thread = this;
+            migration.pending_acks = 0;
+            migration.commands = new std::vector <command_t>;
+            assert (migration.commands);
+            immigrants.push_back (migration);
+
+            //  Ask the threads on the other ends of engine's pipes to send
+            //  the commands for the engine to this thread from now on.
+            std::vector <pipe_t*> pipes;
+            engine->get_pipes (pipes);
+            for (std::vector <pipe_t*>::iterator it = pipes.begin ();
+                  it != pipes.end (); it ++) {
+                i_thread *peer = (*it)->get_peer_thread (engine);
+                assert (peer);
+                command_t cmd;
+                cmd.init_rehome_pipe (*it, engine, this);
+                send_command (peer, cmd);
+            }
+            break;
+        }
+
+    //  Engine on the other end of the pipe has moved to a different thread.
+    //  Confirm the change to its old thread. The confirmation follows
+    //  all the commands sent to the engine via the old thread.
+    case command_t::rehome_pipe:
+        {
+            engine = command_.args.rehome_pipe.engine;
+            i_thread *old_thread = command_.args.rehome_pipe.pipe->rehome (
+                engine, command_.args.rehome_pipe.thread);
+            command_t cmd;
+            cmd.init_rehome_pipe_ack (engine);
+            send_command (old_thread, cmd);
+            break;
+        }
+
+    //  Redirection of a pipe of an engine moved away was confirmed.
+    case command_t::rehome_pipe_ack:
+        {
+            engine = command_.args.rehome_pipe_ack.engine;
+            typename migrations_t::iterator it;
+            for (it = emigrants.begin (); it != emigrants.end (); it ++)
+                if (it->engine == engine)
+                    break;
+            assert (it != emigrants.end ());
+
+            //  Once all the pipes are redirected, pass the held commands
+            //  to the new thread of the engine.
+            if (-- it->pending_acks == 0) {
+                command_t cmd;
+                cmd.init_resume_engine (engine, it->commands);
+                send_command (it->thread, cmd);
+                emigrants.erase (it);
+            }
+            break;
+        }
+
+    //  Engine moved to this thread was handed over.
+    case command_t::resume_engine:
+        {
+            engine = command_.args.resume_engine.engine;
+            typename migrations_t::iterator it;
+            for (it = immigrants.begin (); it != immigrants.end (); it ++)
+                if (it->engine == engine)
+                    break;
+            assert (it != immigrants.end ());
+            std::vector <command_t> *held = it->commands;
+            immigrants.erase (it);
+
+            engine->cast_to_pollable ()->register_event (this);
+            engines.push_back (engine);
+
+            //  Execute the commands held by the old thread first. The commands
+            //  held by this thread were sent after those.
+            std::vector <command_t> *commands =
+                command_.args.resume_engine.commands;
+            for (size_t i = 0; i != commands->size (); i ++)
+                process_command ((*commands) [i]);
+            for (size_t i = 0; i != held->size (); i ++)
+                process_command ((*held) [i]);
+            delete commands;
+            delete held;
+            break;
+        }
+
     //  Forward the command to the specified engine.
     case command_t::engine_command:
         {
-            //  Forward the command to the engine.
+            //  Engine is being moved. Execute the command later on.
+            if (hold_command (command_))
+                break;
+
+            //  Forward the command to the engine. Commands count towards
+            //  the load of the engine the same way as events do.
             engine = command_.args.engine_command.engine;
+            if (pool) {
+                window_load ++;
+                engine_loads [engine->cast_to_pollable ()] ++;
+            }
             const engine_command_t &engcmd =
                 command_.args.engine_command.command;
             switch (engcmd.type) {
@@ -372,15 +611,136 @@ bool zmq::poller_t <T>::process_command (const command_t &command_)
 }
 
 template <class T>
-void zmq::poller_t <T>::timer_event ()
+void zmq::poller_t <T>::balance ()
+{
+    uint64_t now = clock_ms ();
+    if (now - window_start < io_pool_window)
+        return;
+
+    //  Publish the load measured over the window.
+    pool->set_load (pool_index, window_load);
+
+    //  If this thread is much busier than the least loaded thread, move an
+    //  engine there. Only one engine is moved at a time. The busiest engine
+    //  that would not make the other thread busier than this one is chosen.
+    uint32_t min_load;
+    int target = pool->get_least_loaded (pool_index, &min_load);
+    if (target != -1 && emigrants.empty () &&
+          window_load > min_load + io_pool_min_imbalance) {
+        uint32_t limit = (window_load - min_load) / 2;
+        i_pollable *candidate = NULL;
+        uint32_t candidate_load = 0;
+        for (engine_loads_t::iterator it = engine_loads.begin ();
+              it != engine_loads.end (); it ++)
+            if (it->second <= limit && it->second > candidate_load) {
+                candidate = it->first;
+                candidate_load = it->second;
+            }
+        if (candidate)
+            for (engines_t::iterator it = engines.begin ();
+                  it != engines.end (); it ++)
+                if ((*it)->cast_to_pollable () == candidate) {
+                    if (migrate (*it, target))
+                        pool->add_load (target, candidate_load);
+                    break;
+                }
+    }
+
+    //  Start a new window.
+    window_start = now;
+    window_load = 0;
+    engine_loads.clear ();
+}
+
+template <class T>
+bool zmq::poller_t <T>::migrate (i_engine *engine_, int target_)
+{
+    //  Stop polling on behalf of the engine.
+    if (!engine_->cast_to_pollable ()->detach_event ())
+        return false;
+    engines.erase (std::find (engines.begin (), engines.end (), engine_));
+
+    //  Hold the commands for the engine till all its pipes are redirected
+    //  to the new thread.
+    std::vector <pipe_t*> pipes;
+    engine_->get_pipes (pipes);
+    migration_t migration;
+    migration.engine = engine_;
+    migration.thread = pool->get_thread (target_);
+    migration.pending_acks = pipes.size ();
+    migration.commands = new std::vector <command_t>;
+    assert (migration.commands);
+    emigrants.push_back (migration);
+
+    command_t cmd;
+    cmd.init_adopt_engine (engine_);
+    send_command (migration.thread, cmd);
+
+    //  If there are no pipes, there's nothing to wait for.
+    if (pipes.empty ()) {
+        cmd.init_resume_engine (engine_, migration.commands);
+        send_command (migration.thread, cmd);
+        emigrants.pop_back ();
+    }
+    return true;
+}
+
+template <class T>
+bool zmq::poller_t <T>::hold_command (const command_t &command_)
 {
-    //  Use local copy of timers array as timer handlers may fill new timers
-    //  into the original array.
-    timers_t t = timers;
-    timers.clear ();
+    if (emigrants.empty () && immigrants.empty ())
+        return false;
+
+    i_engine *engine = command_.args.engine_command.engine;
+    for (typename migrations_t::iterator it = emigrants.begin ();
+          it != emigrants.end (); it ++)
+        if (it->engine == engine) {
+            it->commands->push_back (command_);
+            return true;
+        }
+    for (typename migrations_t::iterator it = immigrants.begin ();
+          it != immigrants.end (); it ++)
+        if (it->engine == engine) {
+            it->commands->push_back (command_);
+            return true;
+        }
+    return false;
+}
+
+template <class T>
+void zmq::poller_t <T>::finish_migrations ()
+{
+    //  The old thread is responsible for the engine till it hands it over.
+    for (typename migrations_t::iterator it = emigrants.begin ();
+          it != emigrants.end (); it ++) {
+        it->engine->cast_to_pollable ()->register_event (this);
+        engines.push_back (it->engine);
+        delete it->commands;
+    }
+    emigrants.clear ();
+
+    //  Pick the hand-offs that are already waiting for this thread. Other
+    //  commands are dropped, the same way as they would be if they arrived
+    //  after the thread terminated.
+    for (int source = 0; source != dispatcher->get_thread_count ();
+          source ++) {
+        command_t command;
+        while (dispatcher->read (source, thread_id, &command)) {
+            if (command.type != command_t::resume_engine)
+                continue;
+            i_engine *engine = command.args.resume_engine.engine;
+            engine->cast_to_pollable ()->register_event (this);
+            engines.push_back (engine);
+            delete command.args.resume_engine.commands;
+        }
+    }
 
-    for (timers_t::iterator it = t.begin (); it != t.end (); it ++)
-         (*it)->timer_event ();
+    //  Engines that weren't handed over are unregistered by their old
+    //  threads.
+    for (typename migrations_t::iterator it = immigrants.begin ();
+          it != immigrants.end (); it ++)
+        delete it->commands;
+    immigrants.clear ();
 }
 
 #endif
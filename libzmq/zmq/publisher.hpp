@@ -23,11 +23,16 @@
 #include <vector>
 
 #include <zmq/i_demux.hpp>
+#include <zmq/topic_trie.hpp>
 
 namespace zmq
 {
 
-    //  Object to distribute messages to outbound pipes.
+    //  Object to distribute messages to outbound pipes. Pipes with topics
+    //  (see pipe_t::set_topics) get only the messages beginning with one
+    //  of their topics, the other pipes get all the messages. Full pipe
+    //  stalls the publisher only if its overflow policy is blocking (see
+    //  pipe_t::set_overflow), otherwise it doesn't slow down the others.
 
     class publisher_t : public i_demux
     {
@@ -39,10 +44,12 @@ namespace zmq
         ~publisher_t ();
         void send_to (pipe_t *pipe_);
         bool write (message_t &msg_);
+        size_t write_many (message_t *msgs_, size_t count_);
         void flush ();
         void gap ();
         bool empty ();
         void release_pipe (pipe_t *pipe_);
+        void get_pipes (std::vector <pipe_t*> &pipes_);
         void initialise_shutdown ();
 
     private:
@@ -51,6 +58,25 @@ namespace zmq
         typedef std::vector <pipe_t*> pipes_t;
         pipes_t pipes;
 
+        //  Pipes that get all the messages.
+        pipes_t unfiltered;
+
+        //  Topics of the remaining pipes and number of such pipes.
+        topic_trie_t topics;
+        size_t filtered;
+
+        //  Pipes the message being sent is to be written to. Kept as
+        //  a member to avoid allocation for every message.
+        pipes_t targets;
+
+        //  Handles the full pipes among 'dests_' according to their overflow
+        //  policies. Returns the pipes the message should be written to.
+        pipes_t *overflow (pipes_t *dests_);
+
+        //  Scratch lists used by 'overflow'.
+        pipes_t ready;
+        pipes_t expired;
+
         publisher_t (const publisher_t&);
         void operator = (const publisher_t&);
     };
@@ -21,11 +21,13 @@
 #define __ZMQ_RAW_MESSAGE_HPP_INCLUDED__
 
 #include <assert.h>
+#include <string.h>
 #include <new>
 
 #include <zmq/stdint.hpp>
 #include <zmq/config.hpp>
 #include <zmq/atomic_counter.hpp>
+#include <zmq/message_pool.hpp>
 #include <zmq/err.hpp>
 
 namespace zmq
@@ -40,13 +42,16 @@ namespace zmq
     //  stored in used-supplied memory. In the latter case, ffn member stores
     //  pointer to the function to be used to deallocate the data.
     //  If the buffer is actually shared (there are at least 2 references to it)
-    //  refcount member contains number of references.
+    //  refcount member contains number of references. If the buffer was
+    //  allocated from a message pool, cache member points to the message
+    //  cache it should be returned to. Otherwise it is NULL.
 
     struct message_content_t
     {
         void *data;
         size_t size;
         free_fn *ffn;
+        message_cache_t *cache;
         atomic_counter_t refcount;
     };
 
@@ -57,6 +62,9 @@ namespace zmq
     //  If 'shared' is true, message content pointed to by 'content' is shared,
     //  i.e. you have to use reference counting to manage its lifetime
     //  rather than straighforward malloc/free.
+    //  If 'slice' is true, message is a view of a part of the (shared)
+    //  content. In that case pointer to the message data and message size
+    //  are stored in 'vsm_data' (see raw_message_slice_t).
 
     struct raw_message_t
     {
@@ -73,10 +81,28 @@ namespace zmq
 
         message_content_t *content;
         bool shared;
+        bool slice;
         uint16_t vsm_size;
         unsigned char vsm_data [max_vsm_size];
     };
 
+    //  Data and size of a slice. Stored in 'vsm_data' of the message.
+    struct raw_message_slice_t
+    {
+        unsigned char *data;
+        size_t size;
+    };
+
+    //  Compile-time check that slice fits into the message.
+    typedef char raw_message_slice_check
+        [sizeof (raw_message_slice_t) <= max_vsm_size ? 1 : -1];
+
+#if defined ZMQ_MESSAGE_SIZE
+    //  Compile-time check that the message has the requested size.
+    typedef char raw_message_size_check
+        [sizeof (raw_message_t) == ZMQ_MESSAGE_SIZE ? 1 : -1];
+#endif
+
     //  Initialises a message of the specified size.
     inline void raw_message_init (raw_message_t *msg_, 
         size_t size_)
@@ -87,9 +113,20 @@ namespace zmq
         }
         else {
             msg_->shared = false;
-            msg_->content = (message_content_t*) malloc (
-                sizeof (message_content_t) + size_);
-            errno_assert (msg_->content);
+            msg_->slice = false;
+            msg_->content = NULL;
+#if defined ZMQ_HAVE_MESSAGE_POOL
+            //  If the thread uses message pooling, try to get the block
+            //  from the pool.
+            if (message_cache_t::current)
+                msg_->content = message_cache_t::current->allocate (size_);
+#endif
+            if (!msg_->content) {
+                msg_->content = (message_content_t*) malloc (
+                    sizeof (message_content_t) + size_);
+                errno_assert (msg_->content);
+                msg_->content->cache = NULL;
+            }
             msg_->content->data = (void*) (msg_->content + 1);
             msg_->content->size = size_;
             msg_->content->ffn = NULL;
@@ -108,12 +145,14 @@ namespace zmq
         void *data_, size_t size_, free_fn *ffn_)
     {
         msg_->shared = false;
+        msg_->slice = false;
         msg_->content = (message_content_t*) malloc (
             sizeof (message_content_t));
         errno_assert (msg_->content);
         msg_->content->data = data_;
         msg_->content->size = size_;
         msg_->content->ffn = ffn_;
+        msg_->content->cache = NULL;
         new (&msg_->content->refcount) atomic_counter_t ();
     }
 
@@ -150,7 +189,10 @@ namespace zmq
 
             if (msg_->content->ffn)
                 msg_->content->ffn (msg_->content->data);
-            free (msg_->content);
+            if (msg_->content->cache)
+                message_cache_t::deallocate (msg_->content);
+            else
+                free (msg_->content);
         }
     }
 
@@ -202,6 +244,11 @@ namespace zmq
               (message_content_t*) raw_message_t::delimiter_tag ||
               msg_->content == (message_content_t*) raw_message_t::gap_tag)
             return NULL;
+        if (msg_->slice) {
+            raw_message_slice_t slice;
+            memcpy (&slice, msg_->vsm_data, sizeof (slice));
+            return slice.data;
+        }
         return msg_->content->data;
     }
 
@@ -214,9 +261,34 @@ namespace zmq
               (message_content_t*) raw_message_t::delimiter_tag ||
               msg_->content == (message_content_t*) raw_message_t::gap_tag)
             return 0;
+        if (msg_->slice) {
+            raw_message_slice_t slice;
+            memcpy (&slice, msg_->vsm_data, sizeof (slice));
+            return slice.size;
+        }
         return msg_->content->size;
     }
 
+    //  Initialises the destination message to be a view of 'size_' bytes
+    //  of the source message starting at 'offset_'. The content is shared
+    //  between the two messages, so no data are copied. Source message
+    //  has to be a data message other than VSM. If the destination message
+    //  have contained data prior to the operation these get deallocated.
+    inline void raw_message_slice (raw_message_t *src_, raw_message_t *dest_,
+        size_t offset_, size_t size_)
+    {
+        assert (src_->content > (message_content_t*) raw_message_t::vsm_tag);
+        assert (offset_ + size_ <= raw_message_size (src_));
+
+        raw_message_slice_t slice;
+        slice.data = ((unsigned char*) raw_message_data (src_)) + offset_;
+        slice.size = size_;
+
+        raw_message_copy (src_, dest_);
+        dest_->slice = true;
+        memcpy (dest_->vsm_data, &slice, sizeof (slice));
+    }
+
     //  Returns type of the message.
     inline int raw_message_type (raw_message_t *msg_)
     {
@@ -0,0 +1,97 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __ZMQ_SHARED_EXCHANGE_HPP_INCLUDED__
+#define __ZMQ_SHARED_EXCHANGE_HPP_INCLUDED__
+
+#include <zmq/export.hpp>
+#include <zmq/atomic_ptr.hpp>
+#include <zmq/raw_message.hpp>
+#include <zmq/message.hpp>
+#include <zmq/i_signaler.hpp>
+#include <zmq/out_engine.hpp>
+
+namespace zmq
+{
+
+    //  Front-end to an exchange owned by an API thread that can be used to
+    //  send messages from any number of threads without a mutex. Messages
+    //  are pushed to a lock-free list; the owner thread takes the whole list
+    //  over in a single atomic operation and writes the messages to the
+    //  exchange. Order of messages sent by any single thread is preserved.
+    //  The list is unbounded, i.e. pipe limits of the exchange don't block
+    //  the senders.
+
+    class shared_exchange_t
+    {
+    public:
+
+        //  Sends the message to the exchange. Can be called from any thread.
+        //  0MQ takes responsibility for deallocating the message. Message
+        //  will be empty after the call.
+        ZMQ_EXPORT void send (message_t &message_);
+
+    private:
+
+        //  Only the owner API thread creates, destroys and drains the shared
+        //  exchange. Whenever a message is sent to an empty list, the owner
+        //  is woken up by sending signal 'signal_' to 'signaler_'.
+        shared_exchange_t (out_engine_t *engine_, i_signaler *signaler_,
+            int signal_);
+        ~shared_exchange_t ();
+
+        //  Writes the messages sent so far to the exchange. Messages that
+        //  cannot be written because of pipe limits are kept and retried
+        //  on the next call. Called by the owner thread only.
+        void forward ();
+
+        //  Message on the list.
+        struct node_t
+        {
+            node_t *next;
+            raw_message_t msg;
+        };
+
+        //  Returns the list in the reverse order.
+        static node_t *reverse (node_t *list_);
+
+        //  Exchange to forward the messages to.
+        out_engine_t *engine;
+
+        //  Where to signal the owner thread.
+        i_signaler *signaler;
+        int signal;
+
+        //  Messages taken over by the owner thread, but not yet written
+        //  to the exchange, in the order they were sent in. Accessed by
+        //  the owner thread only.
+        node_t *pending;
+
+        //  Messages sent by other threads in the reverse order.
+        atomic_ptr_t <node_t> sent;
+
+        friend class api_thread_t;
+
+        shared_exchange_t (const shared_exchange_t&);
+        void operator = (const shared_exchange_t&);
+    };
+
+}
+
+#endif
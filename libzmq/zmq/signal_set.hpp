@@ -0,0 +1,196 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __ZMQ_SIGNAL_SET_HPP_INCLUDED__
+#define __ZMQ_SIGNAL_SET_HPP_INCLUDED__
+
+#include <assert.h>
+
+#include <zmq/atomic_bitmap.hpp>
+
+namespace zmq
+{
+
+    //  Hints the CPU that the thread is busy-waiting. Used by the signalers
+    //  when spinning for signals before going asleep.
+    inline void cpu_relax ()
+    {
+#if (defined __i386__ || defined __x86_64__) && defined __GNUC__
+        __asm__ volatile ("pause");
+#endif
+    }
+
+    //  Signals retrieved from signal_set_t. Individual signals are extracted
+    //  in ascending order using 'pop' method. The cost of extraction is
+    //  proportional to the number of signals present rather than to the
+    //  number of possible signals.
+
+    class signals_t
+    {
+    public:
+
+        typedef atomic_bitmap_t::integer_t integer_t;
+
+        enum {word_bits = sizeof (integer_t) * 8};
+
+        inline signals_t () :
+            summary (0)
+        {
+        }
+
+        //  Returns true if there are no more signals.
+        inline bool empty ()
+        {
+            return summary == 0;
+        }
+
+        //  Removes the lowest signal from the set and returns it. Returns -1
+        //  if there are no more signals.
+        inline int pop ()
+        {
+            if (!summary)
+                return -1;
+            int word = lowest_bit (summary);
+            int bit = lowest_bit (words [word]);
+            words [word] &= words [word] - 1;
+            if (!words [word])
+                summary &= summary - 1;
+            return word * word_bits + bit;
+        }
+
+    private:
+
+        //  Returns index of the least significant bit set in the value.
+        static inline int lowest_bit (integer_t value_)
+        {
+#if defined __GNUC__
+            return __builtin_ctzll (value_);
+#else
+            int index = 0;
+            while (!(value_ & 1)) {
+                value_ >>= 1;
+                index ++;
+            }
+            return index;
+#endif
+        }
+
+        //  Bit N is set if words [N] contains at least one signal.
+        integer_t summary;
+
+        //  Signals themselves. Only words marked in summary are valid.
+        integer_t words [word_bits - 1];
+
+        friend class signal_set_t;
+    };
+
+    //  Lock-free set of signals for use by signalers. Any thread can add
+    //  a signal to the set, only a single thread can retrieve them.
+    //
+    //  The set is a two-level bitmap. Signals are stored in an array of
+    //  words, while the summary word marks the words that may contain
+    //  signals. This way the number of signals is not limited by the size
+    //  of a machine word and the reader doesn't have to inspect words with
+    //  no signals in them. Most significant bit of the summary word is used
+    //  to mark that the reader is waiting for signals.
+
+    class signal_set_t
+    {
+    public:
+
+        typedef atomic_bitmap_t::integer_t integer_t;
+
+        enum
+        {
+            word_bits = signals_t::word_bits,
+            wait_bit = word_bits - 1,
+
+            //  Maximal number of distinct signals.
+            max_signals = (word_bits - 1) * word_bits
+        };
+
+        inline signal_set_t ()
+        {
+        }
+
+        //  Adds the signal to the set. Returns true if the reader is waiting
+        //  for signals and thus has to be woken up.
+        inline bool set (int signal_)
+        {
+            assert (signal_ >= 0 && signal_ < max_signals);
+            int word = signal_ / word_bits;
+
+            //  If the signal is already present, whoever have set it have
+            //  taken care of waking up the reader.
+            if (words [word].bts (signal_ % word_bits))
+                return false;
+
+            return summary.btsr (word, wait_bit);
+        }
+
+        //  Moves all the signals from the set to 'signals_'. Returns false
+        //  if there are no signals. In such case, if 'wait_' is true, the
+        //  set is marked as having reader waiting for signals. If 'wait_' is
+        //  false, the mark is removed.
+        inline bool get (signals_t &signals_, bool wait_)
+        {
+            signals_.summary = 0;
+            while (true) {
+                integer_t old = wait_ ?
+                    summary.izte (integer_t (1) << wait_bit, 0) :
+                    summary.xchg (0);
+                integer_t marked = old & ~(integer_t (1) << wait_bit);
+                if (!marked) {
+
+                    //  If the reader was marked as waiting already, the mark
+                    //  was just removed by 'izte'. Put it back.
+                    if (wait_ && old)
+                        continue;
+                    return false;
+                }
+
+                //  Word marked in the summary may have been emptied already
+                //  while processing a previous mark. Thus it may happen that
+                //  no signals are retrieved and we have to start anew.
+                while (marked) {
+                    int word = signals_t::lowest_bit (marked);
+                    marked &= marked - 1;
+                    integer_t bits = words [word].xchg (0);
+                    if (bits) {
+                        signals_.words [word] = bits;
+                        signals_.summary |= integer_t (1) << word;
+                    }
+                }
+                if (!signals_.empty ())
+                    return true;
+            }
+        }
+
+    private:
+
+        atomic_bitmap_t summary;
+        atomic_bitmap_t words [word_bits - 1];
+
+        signal_set_t (const signal_set_t&);
+        void operator = (const signal_set_t&);
+    };
+
+}
+
+#endif
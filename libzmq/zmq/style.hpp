@@ -0,0 +1,47 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __ZMQ_STYLE_HPP_INCLUDED__
+#define __ZMQ_STYLE_HPP_INCLUDED__
+
+namespace zmq
+{
+
+    //  Different styles of routing the messages.
+    enum style_t
+    {
+        //  Each message is sent to all the bound queues.
+        style_data_distribution = 1,
+
+        //  Each message is sent to exactly one queue, queues are chosen
+        //  in round-robin fashion.
+        style_load_balancing = 2,
+
+        //  Each message is sent to the queue with the fewest messages
+        //  waiting to be processed.
+        style_least_loaded = 3,
+
+        //  Each message is sent to the less loaded of two randomly chosen
+        //  queues.
+        style_two_choices = 4
+    };
+
+}
+
+#endif
@@ -27,6 +27,7 @@
 #include <zmq/stdint.hpp>
 #include <zmq/tcp_listener.hpp>
 #include <zmq/fd.hpp>
+#include <zmq/io_vector.hpp>
 
 namespace zmq
 {
@@ -71,6 +72,11 @@ namespace zmq
         //  of orderly shutdown by the other peer -1 is returned.
         ZMQ_EXPORT int write (const void *data, int size);
 
+        //  Writes data described by the 'iov' array (up to max_io_vectors
+        //  items) to the socket in a single operation. Return value has
+        //  the same semantics as in the case of 'write'.
+        ZMQ_EXPORT int writev (const io_vector_t *iov, int count);
+
         //  Reads data from the socket (up to 'size' bytes). Returns the number
         //  of bytes actually read (even zero is to be considered to be
         //  a success). In case of orderly shutdown by the other peer -1 is
@@ -22,6 +22,7 @@
 
 #include <zmq/export.hpp>
 #include <zmq/platform.hpp>
+#include <zmq/stdint.hpp>
 
 #ifdef ZMQ_HAVE_WINDOWS
 #include <zmq/windows.hpp>
@@ -51,12 +52,21 @@ namespace zmq
         }
 
         //  Creates OS thread. 'tfn' is main thread function. It'll be passed
-        //  'arg' as an argument.
-        ZMQ_EXPORT void start (thread_fn *tfn_, void *arg_);
+        //  'arg' as an argument. If 'affinity' is non-zero, the thread is
+        //  pinned to the CPUs it specifies (see set_affinity) before 'tfn'
+        //  is invoked, so that the memory it touches first is allocated
+        //  on the NUMA node of those CPUs.
+        ZMQ_EXPORT void start (thread_fn *tfn_, void *arg_,
+            uint64_t affinity_ = 0);
 
         //  Waits for thread termination.
         ZMQ_EXPORT void stop ();
 
+        //  Pins the calling thread to the set of CPUs. Bit N of 'affinity'
+        //  stands for CPU N. Zero means no restriction and leaves the thread
+        //  as it is. Ignored on platforms without thread affinity support.
+        ZMQ_EXPORT static void set_affinity (uint64_t affinity_);
+
     private:
 
 #ifdef ZMQ_HAVE_WINDOWS
@@ -69,6 +79,7 @@ namespace zmq
 
         thread_fn *tfn;
         void *arg;
+        uint64_t affinity;
 
         thread_t (const thread_t&);
         void operator = (const thread_t&);
@@ -0,0 +1,130 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __ZMQ_TIMER_WHEEL_HPP_INCLUDED__
+#define __ZMQ_TIMER_WHEEL_HPP_INCLUDED__
+
+#include <stddef.h>
+
+#include <zmq/export.hpp>
+#include <zmq/stdint.hpp>
+#include <zmq/i_pollable.hpp>
+
+namespace zmq
+{
+
+    //  Hierarchical timer wheel used by I/O threads. Time is measured in
+    //  milliseconds. Level 0 has a slot for each of the next 64 ms, level 1
+    //  a slot for each of the next 64 blocks of 64 ms etc. Once the time
+    //  reaches the beginning of the block covered by a slot on a higher
+    //  level, the timers in the slot are redistributed to the lower levels
+    //  ("cascading"). Adding and cancelling a timer is O(1), each timer is
+    //  cascaded at most once per level. A bitmap of non-empty slots is kept
+    //  for each level so that the time of the nearest expiry or cascade can
+    //  be found without scanning the slots.
+    //
+    //  The wheel is used by a single thread, so there's no synchronisation.
+
+    class timer_wheel_t
+    {
+    public:
+
+        ZMQ_EXPORT timer_wheel_t ();
+        ZMQ_EXPORT ~timer_wheel_t ();
+
+        //  Adds a timer that expires 'timeout_' milliseconds after 'now_'.
+        //  Returns a handle to be used to cancel the timer.
+        ZMQ_EXPORT void *add (i_pollable *engine_, uint64_t now_, int timeout_);
+
+        //  Cancels the timer. The timer must not have expired yet.
+        ZMQ_EXPORT void cancel (void *timer_);
+
+        //  Returns true if there are no timers.
+        inline bool empty ()
+        {
+            return !count;
+        }
+
+        //  Returns number of milliseconds till the wheel has to be processed
+        //  anew, -1 if there are no timers.
+        ZMQ_EXPORT int timeout (uint64_t now_);
+
+        //  Invokes timer_event on all the engines whose timers expired
+        //  by 'now_'. The engines are free to add new timers.
+        ZMQ_EXPORT void execute (uint64_t now_);
+
+    private:
+
+        enum {
+            levels = 4,
+            slot_bits = 6,
+            slots = 1 << slot_bits,
+            slot_mask = slots - 1
+        };
+
+        //  Timers are stored in circular doubly-linked lists. Each slot has
+        //  a sentinel node of its own so that removing a timer doesn't
+        //  require knowing where it is stored. Nodes of expired and
+        //  cancelled timers are kept on a free-list for reuse.
+        struct node_t
+        {
+            node_t *prev;
+            node_t *next;
+            node_t *slot;
+            i_pollable *engine;
+            uint64_t deadline;
+        };
+
+        //  Links the node to the slot appropriate for its deadline.
+        void insert (node_t *node_);
+
+        //  Unlinks the node from its slot.
+        void unlink (node_t *node_);
+
+        //  Redistributes timers from the slot to the lower levels.
+        void cascade (int level_, int slot_);
+
+        //  Returns the first tick after 'current' at which a timer expires
+        //  or a slot is cascaded. The wheel must not be empty.
+        uint64_t next_tick ();
+
+        //  Returns distance from 'from_' to the first bit set in the bitmap,
+        //  wrapping around at the end. Bitmap must not be zero.
+        static int distance (uint64_t bitmap_, int from_);
+
+        //  Sentinels of the slots and bitmaps of non-empty slots, per level.
+        node_t wheel [levels][slots];
+        uint64_t bitmaps [levels];
+
+        //  Time up to which the timers were processed.
+        uint64_t current;
+
+        //  Number of timers in the wheel.
+        size_t count;
+
+        //  Unused nodes.
+        node_t *free_nodes;
+
+        timer_wheel_t (const timer_wheel_t&);
+        void operator = (const timer_wheel_t&);
+    };
+
+}
+
+#endif
@@ -0,0 +1,93 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __ZMQ_TOPIC_TRIE_HPP_INCLUDED__
+#define __ZMQ_TOPIC_TRIE_HPP_INCLUDED__
+
+#include <stddef.h>
+#include <vector>
+#include <string>
+
+namespace zmq
+{
+
+    class pipe_t;
+
+    //  Prefix trie mapping topics to the pipes subscribed to them. Chains
+    //  of nodes with a single child are merged into a single node
+    //  (radix trie), so the trie has at most twice as many nodes as there
+    //  are distinct topics. Children of a node are sorted by the first
+    //  byte of their label so that matching is a binary search per node.
+
+    class topic_trie_t
+    {
+    public:
+
+        topic_trie_t ();
+        ~topic_trie_t ();
+
+        //  Subscribes the pipe to all messages beginning with 'topic_'.
+        void add (const std::string &topic_, pipe_t *pipe_);
+
+        //  Removes all the subscriptions of the pipe.
+        void remove (pipe_t *pipe_);
+
+        //  Appends the pipes subscribed to a prefix of the data to 'pipes_'.
+        //  A pipe subscribed to several matching prefixes is appended once
+        //  per prefix.
+        void match (const unsigned char *data_, size_t size_,
+            std::vector <pipe_t*> &pipes_);
+
+    private:
+
+        struct node_t
+        {
+            //  Part of the topic between the parent node and this one.
+            std::string label;
+
+            typedef std::vector <node_t*> children_t;
+            children_t children;
+
+            //  Pipes subscribed to the topic ending at this node.
+            typedef std::vector <pipe_t*> pipes_t;
+            pipes_t pipes;
+        };
+
+        //  Returns position of the child whose label begins with 'c_' or
+        //  the position to insert such child to.
+        static node_t::children_t::iterator find_child (node_t *node_,
+            unsigned char c_);
+
+        //  Removes the pipe from the subtree. Returns true if the node
+        //  itself became redundant, in which case it has to be removed
+        //  by the caller.
+        static bool remove (node_t *node_, pipe_t *pipe_);
+
+        //  Deallocates the subtree.
+        static void destroy (node_t *node_);
+
+        node_t root;
+
+        topic_trie_t (const topic_trie_t&);
+        void operator = (const topic_trie_t&);
+    };
+
+}
+
+#endif
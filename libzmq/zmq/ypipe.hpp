@@ -22,6 +22,7 @@
 
 #include <zmq/atomic_ptr.hpp>
 #include <zmq/yqueue.hpp>
+#include <zmq/config.hpp>
 
 namespace zmq
 {
@@ -37,6 +38,11 @@ namespace zmq
     //  in an infinite cycle (if the pipe is continuosly fed by new elements).
     //  N is granularity of the pipe (how many elements have to be inserted
     //  till actual memory allocation is required).
+    //
+    //  Whenever the reader finds the pipe empty, it uses the idle time to
+    //  provide the next chunk for the writer (see yqueue_t::reserve).
+    //  Newly allocated chunks are touched by the reader so that the pipe
+    //  memory is local to the reader's NUMA node.
 
     template <typename T, bool D, int N> class ypipe_t
     {
@@ -125,6 +131,8 @@ namespace zmq
                 //  to deallocate them, this can happen.
                 if (&queue.front () == r || !r) {
                     stop = false;
+                    if (r)
+                        queue.reserve ();
                     return false;
                 }
                 else {
@@ -147,8 +155,11 @@ namespace zmq
                 //  During pipe's lifetime r should never be NULL, however,
                 //  during pipe shutdown when retrieving messages from it
                 //  to deallocate them, this can happen.
-                if (&queue.front () == r || !r)
+                if (&queue.front () == r || !r) {
+                    if (r)
+                        queue.reserve ();
                     return false;
+                }
             }
 
             //  There was at least one value prefetched -
@@ -158,6 +169,25 @@ namespace zmq
             return true;
         }
 
+        //  Reads up to 'max_' items from the pipe into the 'values_' array.
+        //  At most one prefetch (i.e. one atomic operation) is done per call,
+        //  all the items already prefetched are returned in one go. Returns
+        //  number of items actually read.
+        inline size_t read_batch (T *values_, size_t max_)
+        {
+            //  Get the first item. This does the prefetch if needed.
+            if (!max_ || !read (values_))
+                return 0;
+
+            //  Copy out the rest of the prefetched items.
+            size_t count = 1;
+            while (count != max_ && &queue.front () != r) {
+                values_ [count ++] = queue.front ();
+                queue.pop ();
+            }
+            return count;
+        }
+
     protected:
 
         //  Allocation-efficient queue to store pipe items.
@@ -165,24 +195,33 @@ namespace zmq
         //  the pipe points to last un-flushed item. Front is used only by
         //  reader thread, while back is used only by writer thread.
         yqueue_t <T, N> queue;
+        unsigned char queue_pad [cache_line_size];
+
+        //  Writer-only, reader-only and shared variables are placed on
+        //  separate cache lines to avoid false sharing. The padding after
+        //  the last group ensures that when pipes are allocated in an array
+        //  (see dispatcher_t) no two pipes share a cache line.
 
         //  Points to the first un-flushed item. This variable is used
         //  exclusively by writer thread.  
         T *w;
+        unsigned char writer_pad [cache_line_size];
 
         //  Points to the first un-prefetched item. This variable is used
         //  exclusively by reader thread.  
         T *r;
 
-        //  The single contention point of contention between writer and
-        //  reader thread. Points past the last flushed item. If it is NULL,
-        //  reader is asleep.
-        atomic_ptr_t <T> c;
-
         //  Used only if 'D' template parameter is set to true. If true,
         //  prefetch was already done since last sleeping and the reader
         //  should go asleep instead of prefetching once more.
         bool stop;
+        unsigned char reader_pad [cache_line_size];
+
+        //  The single contention point of contention between writer and
+        //  reader thread. Points past the last flushed item. If it is NULL,
+        //  reader is asleep.
+        atomic_ptr_t <T> c;
+        unsigned char shared_pad [cache_line_size];
 
         //  Disable copying of ypipe object.
         ypipe_t (const ypipe_t&);
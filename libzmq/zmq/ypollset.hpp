@@ -23,23 +23,21 @@
 #include <assert.h>
 
 #include <zmq/i_signaler.hpp>
-#include <zmq/atomic_bitmap.hpp>
+#include <zmq/signal_set.hpp>
 #include <zmq/ysemaphore.hpp>
-#include <zmq/stdint.hpp>
+#include <zmq/config.hpp>
 
 namespace zmq
 {
 
-    //  ypollset allows for rapid polling for up to constant number of  
-    //  different signals each produced by a different thread. The number of
-    //  possible signals is platform-dependent.
+    //  ypollset allows for rapid polling for signals each produced by
+    //  a different thread. Up to signal_set_t::max_signals different signals
+    //  are supported.
 
     class ypollset_t : public i_signaler
     {
     public:
 
-        typedef atomic_bitmap_t::integer_t integer_t;
-
         //  Create the pollset.
         inline ypollset_t ()
         {
@@ -48,46 +46,41 @@ namespace zmq
         //  Send a signal to the pollset (i_singnaler implementation).
         void signal (int signal_);
 
-        //  Wait for signal. Returns a set of signals in form of a bitmap.
-        //  Signal with index 0 corresponds to value 1, index 1 to value 2,
-        //  index 2 to value 3 etc.
-        inline integer_t poll ()
+        //  Wait for signals. Retrieved signals are stored in 'signals_'.
+        inline void poll (signals_t &signals_)
         {
-            integer_t result = 0;
-            while (!result) {
-                result = bits.izte (integer_t (1) << wait_signal, 0);
-                if (!result) {
-                    sem.wait ();
-                    result = bits.xchg (0);
-                }
-
-                //  If btsr was really atomic, result would never be 0 at this
-                //  point, i.e. no looping would be possible. This is the case
-                //  when mutexes are used instead of x86 atomic operations.
-                //  However, on x86 platform btsr is composed of two atomic
-                //  operations: bts and btr. If reader thread processes the
-                //  signals between bts and btr (this can happen because another
-                //  writing thread can unlock writer thread in the meantime)
-                //  the result may actually be 0. Thus looping can occur
-                //  sporadically.
+            //  Spin for a while before going asleep, if requested.
+            for (int i = 0; i != api_thread_spin_count; i ++) {
+                if (set.get (signals_, false))
+                    return;
+                cpu_relax ();
+            }
+
+            while (true) {
+                if (set.get (signals_, true))
+                    return;
+                sem.wait ();
+
+                //  The semaphore may have been posted by a thread whose
+                //  signal was already retrieved. Thus we may end up with
+                //  no signals and have to wait anew.
+                if (set.get (signals_, false))
+                    return;
             }
-            return result;      
         }
 
         //  Same as poll, however, if there is no signal available,
-        //  function returns zero immediately instead of waiting for a signal.
-        inline integer_t check ()
+        //  function returns false immediately instead of waiting for
+        //  a signal.
+        inline bool check (signals_t &signals_)
         {
-            return bits.xchg (0);
+            return set.get (signals_, false);
         }
 
     private:
 
-        //  Wait signal is carried in the most significant bit of integer.
-        enum {wait_signal = sizeof (integer_t) * 8 - 1};
-
-        //  The bits of the pollset.
-        atomic_bitmap_t bits;
+        //  The signals.
+        signal_set_t set;
 
         //  Used by thread waiting for signals to sleep if there are no
         //  signals available.
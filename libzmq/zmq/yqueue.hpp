@@ -22,6 +22,10 @@
 
 #include <assert.h>
 #include <stddef.h>
+#include <string.h>
+
+#include <zmq/atomic_ptr.hpp>
+#include <zmq/config.hpp>
 
 namespace zmq
 {
@@ -35,6 +39,17 @@ namespace zmq
     //  pop on the empty queue and that both threads don't access the same
     //  element in unsynchronised manner.
     //
+    //  The most recently freed chunk is kept aside and reused by the next
+    //  push that needs a new chunk. Thus, if reader and writer are running
+    //  at similar speeds, no allocation is done in the steady state.
+    //  Additionally, the reader can provide the spare chunk in advance
+    //  (see reserve).
+    //  Chunks allocated this way are touched by the reader before they
+    //  are passed to the writer. Memory is physically allocated on the NUMA
+    //  node of the thread that touches it first, so the chunks end up local
+    //  to the reader, which is the side that has to fetch the data from
+    //  them. Recycled chunks stay where they were allocated.
+    //
     //  T is the type of the object in the queue
     //  N is granularity of the queue (how many pushes have to be done till
     //  actual memory allocation is required)
@@ -53,6 +68,7 @@ namespace zmq
              back_pos = 0;
              end_chunk = begin_chunk;
              end_pos = 0;
+             free_chunk = NULL;
         }
 
         //  Destroy the queue.
@@ -65,6 +81,12 @@ namespace zmq
                 if (o == end_chunk)
                     break;
             }
+
+            chunk_t *sc = spare_chunk.xchg (NULL);
+            if (sc)
+                delete sc;
+            if (free_chunk)
+                delete free_chunk;
         }
 
         //  Returns reference to the front element of the queue.
@@ -90,8 +112,15 @@ namespace zmq
             if (++ end_pos != N)
                 return;
 
-            end_chunk->next = new chunk_t;
-            assert (end_chunk->next);
+            //  Reuse the spare chunk, if there's one available. Otherwise
+            //  allocate a new one.
+            chunk_t *sc = spare_chunk.xchg (NULL);
+            if (sc)
+                end_chunk->next = sc;
+            else {
+                end_chunk->next = new chunk_t;
+                assert (end_chunk->next);
+            }
             end_chunk = end_chunk->next;
             end_pos = 0;
         }
@@ -103,10 +132,43 @@ namespace zmq
                 chunk_t *o = begin_chunk;
                 begin_chunk = begin_chunk->next;
                 begin_pos = 0;
-                delete o;
+
+                //  Keep the chunk aside to be reused by the writer. If there
+                //  already was a spare chunk, keep it for the next reserve
+                //  rather than deallocating it.
+                chunk_t *cs = spare_chunk.xchg (o);
+                if (cs) {
+                    if (free_chunk)
+                        delete free_chunk;
+                    free_chunk = cs;
+                }
             }
         }
 
+        //  Makes sure there's a spare chunk for the writer to use. Chunk
+        //  freed by the reader is used if available, otherwise a new chunk
+        //  is allocated and touched in the context of the calling thread.
+        //  Can be called only by the reader.
+        inline void reserve ()
+        {
+            if (spare_chunk.get ())
+                return;
+
+            chunk_t *sc = free_chunk;
+            if (sc)
+                free_chunk = NULL;
+            else {
+                sc = new chunk_t;
+                assert (sc);
+                memset (sc, 0, sizeof (chunk_t));
+            }
+
+            //  The writer only ever takes the spare chunk, so no one else
+            //  can have filled the slot in the meantime.
+            chunk_t *prev = spare_chunk.cas (NULL, sc);
+            assert (!prev);
+        }
+
     private:
 
         //  Individual memory chunk to hold N elements.
@@ -120,12 +182,25 @@ namespace zmq
         //  while begin & end positions are always valid. Begin position is
         //  accessed exclusively be queue reader (front/pop), while back and
         //  end positions are accessed exclusively by queue writer (back/push).
+        //  Reader-side and writer-side positions are placed on separate
+        //  cache lines so that one thread doesn't invalidate the cache line
+        //  the other one is working with.
         chunk_t *begin_chunk;
         int begin_pos;
+
+        //  Spare chunk displaced by a more recently freed one. It is used
+        //  by the next reserve. Accessed exclusively by the reader.
+        chunk_t *free_chunk;
+        unsigned char reader_pad [cache_line_size];
         chunk_t *back_chunk;
         int back_pos;
         chunk_t *end_chunk;
         int end_pos;
+        unsigned char writer_pad [cache_line_size];
+
+        //  Most recently freed chunk. It is shared by reader and writer
+        //  thread, thus it is accessed using atomic operations only.
+        atomic_ptr_t <chunk_t> spare_chunk;
 
         //  Disable copying of yqueue.
         yqueue_t (const yqueue_t&);
@@ -26,7 +26,12 @@
 #include <zmq/i_signaler.hpp>
 #include <zmq/err.hpp>
 
-#if (defined ZMQ_HAVE_LINUX || defined ZMQ_HAVE_OSX || defined ZMQ_HAVE_OPENVMS)
+#if defined ZMQ_HAVE_LINUX && defined __GNUC__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#elif (defined ZMQ_HAVE_LINUX || defined ZMQ_HAVE_OSX ||\
+    defined ZMQ_HAVE_OPENVMS)
 #include <pthread.h>
 #elif defined ZMQ_HAVE_WINDOWS
 #include <zmq/windows.hpp>
@@ -45,12 +50,77 @@ namespace zmq
     //  Implementation notes:
     //
     //  - Default implementation uses POSIX semaphore.
-    //  - On Linux and OS X platform optimised version is supplied using
-    //    mutex instead of semaphore.
+    //  - On Linux platform optimised version is supplied using futex.
+    //    Posting the semaphore requires a system call only if the waiting
+    //    thread is actually asleep.
+    //  - On OS X platform optimised version is supplied using mutex
+    //    instead of semaphore.
     //  - On Windows platform simple semaphore is implemented using
     //    event object.
 
-#if (defined ZMQ_HAVE_LINUX || defined ZMQ_HAVE_OSX || defined ZMQ_HAVE_OPENVMS)
+#if defined ZMQ_HAVE_LINUX && defined __GNUC__
+
+    class ysemaphore_t : public i_signaler
+    { 
+    public:
+
+        //  Initialise the semaphore.
+        inline ysemaphore_t () :
+            state (empty)
+        {
+        }
+
+        //  Destroy the semaphore.
+        inline ~ysemaphore_t ()
+        {
+        }
+
+        //  Wait for the semaphore.
+        inline void wait ()
+        {
+            while (true) {
+
+                //  If the semaphore was posted, consume the post.
+                int old = __sync_val_compare_and_swap (&state, posted, empty);
+                if (old == posted)
+                    return;
+
+                //  Announce that we are going asleep. If the semaphore was
+                //  posted in the meantime, start anew.
+                if (old == empty && __sync_val_compare_and_swap (&state,
+                      empty, sleeping) == posted)
+                    continue;
+
+                int rc = syscall (SYS_futex, &state, FUTEX_WAIT_PRIVATE,
+                    sleeping, NULL, NULL, 0);
+                errno_assert (rc == 0 || errno == EWOULDBLOCK ||
+                    errno == EINTR);
+            }
+        }
+
+        //  Post the semaphore.
+        void signal (int signal_);
+
+    private:
+
+        enum
+        {
+            empty,
+            posted,
+            sleeping
+        };
+
+        //  State of the semaphore. The waiting thread is asleep on the futex
+        //  only if the state is 'sleeping'.
+        volatile int state;
+
+        //  Disable copying of ysemaphore object.
+        ysemaphore_t (const ysemaphore_t&);
+        void operator = (const ysemaphore_t&);
+    };
+
+#elif (defined ZMQ_HAVE_LINUX || defined ZMQ_HAVE_OSX ||\
+    defined ZMQ_HAVE_OPENVMS)
 
     class ysemaphore_t : public i_signaler
     { 
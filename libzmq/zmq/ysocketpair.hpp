@@ -25,6 +25,7 @@
 #include <zmq/platform.hpp>
 #include <zmq/stdint.hpp>
 #include <zmq/i_signaler.hpp>
+#include <zmq/signal_set.hpp>
 #include <zmq/err.hpp>
 #include <zmq/tcp_socket.hpp>
 #include <zmq/tcp_listener.hpp>
@@ -53,13 +54,15 @@ namespace zmq
     //  another. The specific of this pipe is that it has associated file
     //  descriptor and so it can be polled on. Same signal cannot be sent twice
     //  unless signals are retrieved by the reader side in the meantime.
+    //  The signals themselves are passed in a signal set, file descriptor
+    //  is used only to wake up the reader. To avoid unnecessary system calls
+    //  the file descriptor is written to only if the reader is parked, i.e.
+    //  if it found no signals the last time it checked.
 
     class ysocketpair_t : public i_signaler
     {
     public:
 
-        typedef uint64_t integer_t;
-
         //  Initialise the object.
         ZMQ_EXPORT ysocketpair_t ();
 
@@ -69,11 +72,15 @@ namespace zmq
         //  Send specific signal.
         void signal (int signal_);
 
-        //  Retrieves signals. Returns a set of signals in form of a bitmap.
-        //  Signal with index 0 corresponds to value 1, index 1 to value 2,
-        //  index 2 to value 4 etc. If there is no signal available,
-        //  it returns zero immediately.
-        integer_t check ();
+        //  Retrieves signals and stores them in 'signals_'. Returns false
+        //  if there are no signals available. In such case, if 'park_' is
+        //  true, the reader is marked as parked and the next signal is going
+        //  to make the file descriptor readable.
+        bool check (signals_t &signals_, bool park_ = true);
+
+        //  Drains the file descriptor. Should be called only when the file
+        //  descriptor is signaled as readable.
+        void reset ();
 
         //  Get the file descriptor associated with the object.
         ZMQ_EXPORT fd_t get_fd ();
@@ -103,6 +110,9 @@ namespace zmq
         fd_t r;
 #endif
 
+        //  The signals.
+        signal_set_t set;
+
         //  Disable copying of ysocketpair object.
         ysocketpair_t (const ysocketpair_t&);
         void operator = (const ysocketpair_t&);
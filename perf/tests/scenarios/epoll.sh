@@ -0,0 +1,71 @@
+#!/bin/sh
+#
+# Copyright (c) 2007-2009 FastMQ Inc.
+#
+# This file is part of 0MQ.
+#
+# 0MQ is free software; you can redistribute it and/or modify it under
+# the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# 0MQ is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# Lesser GNU General Public License for more details.
+#
+# You should have received a copy of the Lesser GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Compares number of system calls per message done by the sender when using
+# level-triggered and edge-triggered polling (see "edge_triggered" engine
+# option). For each mode and message size throughput test is run. Remote
+# side prints the numbers of system calls, local side stores the throughput
+# into epoll_<mode>.dat files. The numbers of system calls are available only
+# if 0MQ is built with performance counters (--enable-counters).
+
+GL_IP="127.0.0.1"
+EXCH_IF="127.0.0.1:5555"
+QUEUE_IF="127.0.0.1:5556"
+
+MSG_SIZE_STEPS=${MSG_SIZE_STEPS:-12}
+MSG_COUNT=${MSG_COUNT:-1000000}
+
+LOCAL_THR_BIN=${LOCAL_THR_BIN:-"/home/sustrik/zeromq/perf/tests/zmq/local_thr"}
+REMOTE_THR_BIN=${REMOTE_THR_BIN:-"/home/sustrik/zeromq/perf/tests/zmq/remote_thr"}
+
+MODES="0 1"
+
+################### Do not edit below this line ###############################
+
+
+if [ $# -ne 1 ]; then
+    echo "Usage: epoll.sh [local | remote]"
+    exit 1
+fi
+
+if [ $1 != "local" -a $1 != "remote" ]; then
+    echo "Usage: epoll.sh [local | remote]"
+    exit 1
+fi
+
+for MODE in $MODES;
+do
+    echo "edge_triggered=$MODE"
+    for i in `seq 0 $MSG_SIZE_STEPS`;
+    do
+        let MSG_SIZE=2**$i
+
+        if [ $1 = "local" ]; then
+            $LOCAL_THR_BIN $GL_IP $EXCH_IF $QUEUE_IF $MSG_SIZE $MSG_COUNT
+        else
+            sleep 1
+            $REMOTE_THR_BIN $GL_IP $MSG_SIZE $MSG_COUNT \
+                "edge_triggered=$MODE" | grep "syscalls per message"
+        fi
+    done
+
+    if [ $1 = "local" -a -f tests.dat ]; then
+        mv tests.dat epoll_$MODE.dat
+    fi
+done
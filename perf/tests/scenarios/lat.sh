@@ -25,14 +25,14 @@ REC_IP="192.168.1.1"
 REC_PORT=5672
 
 MSG_SIZE_START=1
-MSG_SIZE_STEPS=16
+MSG_SIZE_STEPS=${MSG_SIZE_STEPS:-16}
 
-RUNS=1
+RUNS=${RUNS:-1}
 
 TEST_TIME=250
 
-LOCAL_LAT_BIN="/home/sustrik/zeromq/perf/tests/zmq/local_lat"
-REMOTE_LAT_BIN="/home/sustrik/zeromq/perf/tests/zmq/remote_lat"
+LOCAL_LAT_BIN=${LOCAL_LAT_BIN:-"/home/sustrik/zeromq/perf/tests/zmq/local_lat"}
+REMOTE_LAT_BIN=${REMOTE_LAT_BIN:-"/home/sustrik/zeromq/perf/tests/zmq/remote_lat"}
 
 ######################## Do not edit below this line ##########################
 
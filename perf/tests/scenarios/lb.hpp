@@ -0,0 +1,165 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+    Message flow diagram - load balancing (fan out of requests to the
+    workers, fan in of the replies)
+
+          'local'                  'worker 1'              'worker 2'
+      (started first)           (fast, started          (slow, started
+             |                     second)                 third)
+             |                         |                        |
+             |  sync message (size 1B) |                        |
+             |<------------------------|                        |
+             |                         | sync message (size 1B) |
+             |<-------------------------------------------------|
+             |                         |                        |
+             |  'window' requests sent upfront, each request    |
+             |  distributed to a single worker                  |
+             |========================>|                        |
+             |=================================================>|
+             |                         |                        |
+             |  reply (same size)      |                        |
+             |<------------------------|                        |
+             |  new request sent for each reply received        |
+             |------------------------------------------------->|
+             |                         |                        |
+             ...    message count      |                        |
+             |                         |                        |
+      resuls gathering                 v                        v
+        computations
+             |
+             v
+
+    Request sizes identify the slots of the window, thus the latency of each
+    individual request can be measured. Workers busy-loop for their service
+    time before replying, so workers with different service times simulate
+    heterogeneous consumers.
+*/
+
+#ifndef __PERF_LB_HPP_INCLUDED__
+#define __PERF_LB_HPP_INCLUDED__
+
+#include <algorithm>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <assert.h>
+
+#include "../../transports/i_transport.hpp"
+#include "../../helpers/time.hpp"
+
+namespace perf
+{
+    //  Function sends msg_count_ requests, keeping up to window_ of them
+    //  in flight, and waits for the replies. Request sizes are msg_size_
+    //  plus the window slot number. Latencies of the individual requests
+    //  are measured and their percentiles are reported.
+    void local_lb (i_transport *transport_, size_t msg_size_,
+        int msg_count_, int window_, int workers_count_)
+    {
+        //  Sync messages have to be distinguishable from the replies.
+        assert (msg_size_ > 1);
+        assert (window_ > 0 && window_ <= msg_count_);
+
+        //  Wait for a sync message from each of the workers.
+        for (int worker_nbr = 0; worker_nbr < workers_count_; worker_nbr++) {
+            size_t size = transport_->receive ();
+            assert (size == 1);
+        }
+
+        std::vector <time_instant_t> sent (window_);
+        std::vector <uint64_t> latencies;
+        latencies.reserve (msg_count_);
+
+        //  Fill the window.
+        time_instant_t start_time = now ();
+        for (int slot = 0; slot < window_; slot++) {
+            sent [slot] = now ();
+            transport_->send (msg_size_ + slot);
+        }
+        int requests = window_;
+
+        //  Each reply frees a slot, reuse it for the next request.
+        while ((int) latencies.size () < msg_count_) {
+            size_t size = transport_->receive ();
+            assert (size >= msg_size_ && size < msg_size_ + window_);
+            size_t slot = size - msg_size_;
+            time_instant_t reply_time = now ();
+            latencies.push_back (reply_time - sent [slot]);
+            if (requests < msg_count_) {
+                sent [slot] = reply_time;
+                transport_->send (size);
+                requests ++;
+            }
+        }
+        time_instant_t stop_time = now ();
+
+        //  Calculate & print results.
+        std::sort (latencies.begin (), latencies.end ());
+        uint64_t p50 = latencies [latencies.size () / 2] / 1000;
+        uint64_t p99 = latencies [latencies.size () * 99 / 100] / 1000;
+        uint64_t p999 = latencies [latencies.size () * 999 / 1000] / 1000;
+        uint64_t max = latencies.back () / 1000;
+        uint64_t msg_thput = ((uint64_t) 1000000000 * (uint64_t) msg_count_) /
+            (uint64_t) (stop_time - start_time);
+
+        std::cout << "Your median latency is " << p50 << " [us]" << std::endl;
+        std::cout << "Your 99th percentile latency is " << p99 << " [us]"
+            << std::endl;
+        std::cout << "Your 99.9th percentile latency is " << p999 << " [us]"
+            << std::endl;
+        std::cout << "Your maximal latency is " << max << " [us]" << std::endl;
+        std::cout << "Your average throughput is " << msg_thput
+            << " [msg/s]" << std::endl << std::endl;
+
+        //  Output file format, separate line for each run is appended
+        //  to the lb_tests.dat file
+        //
+        //  message count, window, msg size [B], median [us], 99th [us],
+        //  99.9th [us], max [us], throughput [msg/s]
+        //
+        std::ofstream outf ("lb_tests.dat", std::ios::out | std::ios::app);
+        assert (outf.is_open ());
+        outf << msg_count_ << "," << window_ << "," << msg_size_ << ","
+            << p50 << "," << p99 << "," << p999 << "," << max << ","
+            << msg_thput << std::endl;
+        outf.close ();
+    }
+
+    //  Worker function. Echoes the requests back, spending service_time_
+    //  (in microseconds) processing each of them. Runs until the process
+    //  is terminated.
+    void remote_lb (i_transport *transport_, uint64_t service_time_)
+    {
+        //  Send sync message that we are ready to receive the requests.
+        transport_->send (1);
+
+        while (true) {
+            size_t size = transport_->receive ();
+            if (service_time_) {
+                time_instant_t deadline = now () + service_time_ * 1000;
+                while (now () < deadline)
+                    ;
+            }
+            transport_->send (size);
+        }
+    }
+}
+#endif
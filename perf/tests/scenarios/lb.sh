@@ -0,0 +1,56 @@
+#!/bin/sh
+#
+# Copyright (c) 2007-2009 FastMQ Inc.
+#
+# This file is part of 0MQ.
+#
+# 0MQ is free software; you can redistribute it and/or modify it under
+# the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# 0MQ is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# Lesser GNU General Public License for more details.
+#
+# You should have received a copy of the Lesser GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Measures tail latency of request/reply traffic load balanced among workers
+# of different speed. The test is run with each of the load balancing styles
+# (2 = round-robin, 3 = least loaded, 4 = two random choices). Results are
+# stored into lb_<style>.dat files.
+
+SERVICE_TIMES=${SERVICE_TIMES:-"0 0 0 500"}
+WINDOWS=${WINDOWS:-"4 16 64"}
+
+MSG_SIZE=${MSG_SIZE:-16}
+MSG_COUNT=${MSG_COUNT:-100000}
+STYLES=${STYLES:-"2 3 4"}
+
+LB_BIN=${LB_BIN:-"/home/sustrik/zeromq/perf/tests/zmq/lb"}
+
+################### Do not edit below this line ###############################
+
+
+if [ $# -ne 0 ]; then
+    echo "Usage: lb.sh"
+    exit 1
+fi
+
+for STYLE in $STYLES;
+do
+    echo "style=$STYLE service times=$SERVICE_TIMES [us]"
+    rm -f lb_$STYLE.dat
+
+    for WINDOW in $WINDOWS;
+    do
+        rm -f lb_tests.dat
+        $LB_BIN $STYLE $MSG_SIZE $MSG_COUNT $WINDOW $SERVICE_TIMES > /dev/null
+        RESULT=`cat lb_tests.dat`
+        echo "window=$WINDOW count,window,size,p50,p99,p99.9,max,thr: $RESULT"
+        echo "$RESULT" >> lb_$STYLE.dat
+    done
+done
+rm -f lb_tests.dat
@@ -0,0 +1,67 @@
+#!/bin/sh
+#
+# Copyright (c) 2007-2009 FastMQ Inc.
+#
+# This file is part of 0MQ.
+#
+# 0MQ is free software; you can redistribute it and/or modify it under
+# the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# 0MQ is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# Lesser GNU General Public License for more details.
+#
+# You should have received a copy of the Lesser GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Demonstrates the cost of passing messages between threads on different
+# sockets of a NUMA machine. ypipe latency and throughput tests are run with
+# both threads pinned to the same socket and with the threads pinned to
+# different sockets. Results are stored into numa_<placement>.dat files.
+# Set the CPU pairs to match the topology of the box (see lscpu).
+
+SAME_SOCKET_CPUS=${SAME_SOCKET_CPUS:-"0 2"}
+CROSS_SOCKET_CPUS=${CROSS_SOCKET_CPUS:-"0 1"}
+
+ROUNDTRIP_COUNT=${ROUNDTRIP_COUNT:-1000000}
+MSG_COUNT=${MSG_COUNT:-10000000}
+BATCH_SIZES=${BATCH_SIZES:-"1 16 256"}
+
+YPIPE_LAT_BIN=${YPIPE_LAT_BIN:-"/home/sustrik/zeromq/perf/tests/ypipe/ypipe_lat"}
+YPIPE_THR_BIN=${YPIPE_THR_BIN:-"/home/sustrik/zeromq/perf/tests/ypipe/ypipe_thr"}
+
+################### Do not edit below this line ###############################
+
+
+if [ $# -ne 0 ]; then
+    echo "Usage: numa.sh"
+    exit 1
+fi
+
+for PLACEMENT in same cross;
+do
+    if [ $PLACEMENT = "same" ]; then
+        CPUS=$SAME_SOCKET_CPUS
+    else
+        CPUS=$CROSS_SOCKET_CPUS
+    fi
+
+    echo "placement=$PLACEMENT ($CPUS)"
+    rm -f numa_$PLACEMENT.dat
+
+    LAT=`$YPIPE_LAT_BIN $ROUNDTRIP_COUNT $CPUS | \
+        grep "average latency" | awk '{print $5}'`
+    echo "latency: $LAT [ns]"
+    echo "lat $LAT" >> numa_$PLACEMENT.dat
+
+    for BATCH_SIZE in $BATCH_SIZES;
+    do
+        THR=`$YPIPE_THR_BIN $MSG_COUNT $BATCH_SIZE $CPUS | \
+            grep "average throughput" | awk '{print $5}'`
+        echo "batch=$BATCH_SIZE throughput: $THR [msg/s]"
+        echo "thr $BATCH_SIZE $THR" >> numa_$PLACEMENT.dat
+    done
+done
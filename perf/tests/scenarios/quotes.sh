@@ -0,0 +1,54 @@
+#!/bin/sh
+#
+# Copyright (c) 2007-2009 FastMQ Inc.
+#
+# This file is part of 0MQ.
+#
+# 0MQ is free software; you can redistribute it and/or modify it under
+# the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# 0MQ is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# Lesser GNU General Public License for more details.
+#
+# You should have received a copy of the Lesser GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Compares the age of the quotes processed by a slow consumer with and
+# without conflation in the queue, for different processing times. Results
+# are stored into quotes_<conflate>.dat files.
+
+MSG_COUNT=${MSG_COUNT:-1000000}
+INSTRUMENT_COUNT=${INSTRUMENT_COUNT:-100}
+PROCESSING_TIMES=${PROCESSING_TIMES:-"0 1 10 100"}
+
+QUOTES_BIN=${QUOTES_BIN:-"/home/sustrik/zeromq/perf/tests/zmq/quotes"}
+
+################### Do not edit below this line ###############################
+
+
+if [ $# -ne 0 ]; then
+    echo "Usage: quotes.sh"
+    exit 1
+fi
+
+for CONFLATE in 0 1;
+do
+    echo "conflate=$CONFLATE"
+    rm -f quotes_$CONFLATE.dat
+
+    for PROCESSING_TIME in $PROCESSING_TIMES;
+    do
+        OUT=`$QUOTES_BIN $MSG_COUNT $INSTRUMENT_COUNT $PROCESSING_TIME \
+            $CONFLATE`
+        COUNT=`echo "$OUT" | grep "processed quote count" | awk '{print $6}'`
+        P50=`echo "$OUT" | grep "median quote age" | awk '{print $6}'`
+        P99=`echo "$OUT" | grep "99th percentile" | awk '{print $7}'`
+        echo "processing=$PROCESSING_TIME [us] processed: $COUNT" \
+            "median age: $P50 [us] 99th percentile age: $P99 [us]"
+        echo "$PROCESSING_TIME $COUNT $P50 $P99" >> quotes_$CONFLATE.dat
+    done
+done
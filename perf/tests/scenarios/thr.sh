@@ -25,15 +25,15 @@ REC_IP="192.168.1.1"
 REC_PORT=5672
 
 MSG_SIZE_START=1
-MSG_SIZE_STEPS=16
+MSG_SIZE_STEPS=${MSG_SIZE_STEPS:-16}
 
 THREADS=1
-RUNS=3
+RUNS=${RUNS:-3}
 
 TEST_TIME=5000
 
-LOCAL_THR_BIN="taskset -c 1,3,5,7 chrt --fifo 1 /home/sustrik/zeromq/perf/tests/zmq/local_thr"
-REMOTE_THR_BIN="taskset -c 1,3,5,7 chrt --fifo 1 /home/sustrik/zeromq/perf/tests/zmq/remote_thr"
+LOCAL_THR_BIN=${LOCAL_THR_BIN:-"taskset -c 1,3,5,7 chrt --fifo 1 /home/sustrik/zeromq/perf/tests/zmq/local_thr"}
+REMOTE_THR_BIN=${REMOTE_THR_BIN:-"taskset -c 1,3,5,7 chrt --fifo 1 /home/sustrik/zeromq/perf/tests/zmq/remote_thr"}
 
 ################### Do not edit below this line ###############################
 
@@ -0,0 +1,83 @@
+#!/bin/sh
+#
+# Copyright (c) 2007-2009 FastMQ Inc.
+#
+# This file is part of 0MQ.
+#
+# 0MQ is free software; you can redistribute it and/or modify it under
+# the terms of the Lesser GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# 0MQ is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# Lesser GNU General Public License for more details.
+#
+# You should have received a copy of the Lesser GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Sweeps the size of raw message structure (see ZMQ_MESSAGE_SIZE). For each
+# size 0MQ is built into a separate directory and throughput or latency
+# scenario is run using the binaries from that build. Results of the local
+# side are stored in tests_<size>.dat files.
+
+SRC_DIR="/home/sustrik/zeromq"
+BUILD_DIR="/tmp/zmq_vsm"
+
+#  "default" stands for the layout used when ZMQ_MESSAGE_SIZE is not set.
+MESSAGE_SIZES="default 64 128"
+
+#  Message sizes 1B - 256B are enough to cross all the VSM thresholds.
+MSG_SIZE_STEPS=8
+
+################### Do not edit below this line ###############################
+
+
+if [ $# -ne 2 ]; then
+    echo "Usage: vsm.sh [thr | lat] [local | remote]"
+    exit 1
+fi
+
+if [ $1 != "thr" -a $1 != "lat" ]; then
+    echo "Usage: vsm.sh [thr | lat] [local | remote]"
+    exit 1
+fi
+
+if [ $2 != "local" -a $2 != "remote" ]; then
+    echo "Usage: vsm.sh [thr | lat] [local | remote]"
+    exit 1
+fi
+
+SCENARIO_DIR=`pwd`
+
+for SIZE in $MESSAGE_SIZES;
+do
+    echo "message size: $SIZE"
+
+    if [ $SIZE = "default" ]; then
+        SIZE_OPTION=""
+    else
+        SIZE_OPTION="-DWITH_MESSAGE_SIZE=$SIZE"
+    fi
+
+    DIR=$BUILD_DIR/$SIZE
+    mkdir -p $DIR
+    (cd $DIR && cmake -DWITH_PERF=ON $SIZE_OPTION $SRC_DIR && make) || exit 1
+
+    if [ $1 = "thr" ]; then
+        LOCAL_THR_BIN=$DIR/perf/tests/zmq/local_thr \
+        REMOTE_THR_BIN=$DIR/perf/tests/zmq/remote_thr \
+        MSG_SIZE_STEPS=$MSG_SIZE_STEPS \
+            sh $SCENARIO_DIR/thr.sh zmq $2
+    else
+        LOCAL_LAT_BIN=$DIR/perf/tests/zmq/local_lat \
+        REMOTE_LAT_BIN=$DIR/perf/tests/zmq/remote_lat \
+        MSG_SIZE_STEPS=$MSG_SIZE_STEPS \
+            sh $SCENARIO_DIR/lat.sh zmq $2
+    fi
+
+    if [ $2 = "local" -a -f tests.dat ]; then
+        mv tests.dat tests_$SIZE.dat
+    fi
+done
@@ -0,0 +1,141 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//  Microbenchmark measuring the cost of passing a single raw_message_t
+//  back and forth between two threads using a pair of ypipe_t objects.
+//  Both threads busy-wait, so the result is dominated by the cost of moving
+//  cache lines between the CPU cores. Pin the two threads to cores on
+//  different sockets to measure cross-socket ping-pong cost.
+
+#include <cassert>
+#include <iostream>
+#include <cstdlib>
+
+#include <zmq/ypipe.hpp>
+#include <zmq/atomic_ptr.hpp>
+#include <zmq/raw_message.hpp>
+#include <zmq/config.hpp>
+#include <zmq/thread.hpp>
+
+#include "../../helpers/time.hpp"
+
+using namespace std;
+
+typedef zmq::ypipe_t <zmq::raw_message_t, false,
+    zmq::message_pipe_granularity> pipe_t;
+
+//  Unidirectional channel. When the pipe dies, reader spins on the 'revived'
+//  flag till the writer revives it.
+class channel_t
+{
+public:
+
+    inline channel_t () :
+        pipe (false)
+    {
+    }
+
+    inline void send (const zmq::raw_message_t &msg_)
+    {
+        pipe.write (msg_);
+        if (!pipe.flush ())
+            revived.xchg (this);
+    }
+
+    inline void receive (zmq::raw_message_t *msg_)
+    {
+        while (!pipe.read (msg_))
+            while (!revived.xchg (NULL))
+                ;
+    }
+
+private:
+
+    pipe_t pipe;
+    zmq::atomic_ptr_t <channel_t> revived;
+};
+
+struct context_t
+{
+    channel_t ping;
+    channel_t pong;
+    int roundtrip_count;
+};
+
+static void echo_routine (void *arg_)
+{
+    context_t *ctx = (context_t*) arg_;
+
+    zmq::raw_message_t msg;
+    for (int msg_nbr = 0; msg_nbr != ctx->roundtrip_count; msg_nbr ++) {
+        ctx->ping.receive (&msg);
+        ctx->pong.send (msg);
+    }
+}
+
+int main (int argc, char *argv [])
+{
+    if (argc != 2 && argc != 4) {
+        cerr << "Usage: ypipe_lat <roundtrip count> "
+            "[<local CPU> <echo CPU>]" << endl;
+        return 1;
+    }
+
+    uint64_t echo_affinity = 0;
+    if (argc == 4) {
+        zmq::thread_t::set_affinity ((uint64_t) 1 << atoi (argv [2]));
+        echo_affinity = (uint64_t) 1 << atoi (argv [3]);
+        cout << "local CPU: " << argv [2] << endl;
+        cout << "echo CPU: " << argv [3] << endl;
+    }
+
+    context_t ctx;
+    ctx.roundtrip_count = atoi (argv [1]);
+
+    cout << "roundtrip count: " << ctx.roundtrip_count << endl;
+    cout << "sizeof (ypipe_t): " << sizeof (pipe_t) << " [B]" << endl;
+
+    zmq::thread_t echo;
+    echo.start (echo_routine, &ctx, echo_affinity);
+
+    zmq::raw_message_t msg;
+    zmq::raw_message_init (&msg, 0);
+
+    perf::time_instant_t start_time = perf::now ();
+
+    for (int msg_nbr = 0; msg_nbr != ctx.roundtrip_count; msg_nbr ++) {
+        ctx.ping.send (msg);
+        ctx.pong.receive (&msg);
+    }
+
+    perf::time_instant_t stop_time = perf::now ();
+    echo.stop ();
+
+    //  Set 2 fixed decimal places.
+    cout.setf (ios::fixed);
+    cout.precision (2);
+
+    //  One-way latency [ns].
+    double latency = (double) (stop_time - start_time) /
+        (double) ctx.roundtrip_count / 2;
+
+    cout << "Your average latency is " << latency << " [ns]" << endl;
+
+    return 0;
+}
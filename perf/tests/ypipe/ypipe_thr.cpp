@@ -0,0 +1,123 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+//  Microbenchmark measuring raw throughput of ypipe_t as used by pipe_t,
+//  i.e. passing raw_message_t structures from one thread to another.
+//  No 0MQ infrastructure (dispatcher, I/O threads) is involved.
+//  Optionally, reader and writer threads can be pinned to particular CPUs
+//  to compare the throughput within a socket and across the sockets.
+
+#include <cassert>
+#include <iostream>
+#include <cstdlib>
+
+#include <zmq/ypipe.hpp>
+#include <zmq/raw_message.hpp>
+#include <zmq/config.hpp>
+#include <zmq/thread.hpp>
+#include <zmq/ysemaphore.hpp>
+
+#include "../../helpers/time.hpp"
+
+using namespace std;
+
+typedef zmq::ypipe_t <zmq::raw_message_t, false,
+    zmq::message_pipe_granularity> pipe_t;
+
+struct context_t
+{
+    inline context_t () :
+        pipe (false)
+    {
+    }
+
+    pipe_t pipe;
+    zmq::ysemaphore_t revive;
+    int msg_count;
+    int batch_size;
+};
+
+static void writer_routine (void *arg_)
+{
+    context_t *ctx = (context_t*) arg_;
+
+    zmq::raw_message_t msg;
+    zmq::raw_message_init (&msg, 0);
+    for (int msg_nbr = 0; msg_nbr != ctx->msg_count; msg_nbr ++) {
+        ctx->pipe.write (msg);
+        if ((msg_nbr + 1) % ctx->batch_size == 0 && !ctx->pipe.flush ())
+            ctx->revive.signal (0);
+    }
+    if (!ctx->pipe.flush ())
+        ctx->revive.signal (0);
+}
+
+int main (int argc, char *argv [])
+{
+    if (argc != 3 && argc != 5) {
+        cerr << "Usage: ypipe_thr <message count> <flush batch size> "
+            "[<reader CPU> <writer CPU>]" << endl;
+        return 1;
+    }
+
+    //  Pin the reader before the pipe is created so that the pipe memory
+    //  is allocated on the reader's NUMA node.
+    uint64_t writer_affinity = 0;
+    if (argc == 5) {
+        zmq::thread_t::set_affinity ((uint64_t) 1 << atoi (argv [3]));
+        writer_affinity = (uint64_t) 1 << atoi (argv [4]);
+        cout << "reader CPU: " << argv [3] << endl;
+        cout << "writer CPU: " << argv [4] << endl;
+    }
+
+    context_t ctx;
+    ctx.msg_count = atoi (argv [1]);
+    ctx.batch_size = atoi (argv [2]);
+    assert (ctx.batch_size > 0);
+
+    cout << "message count: " << ctx.msg_count << endl;
+    cout << "flush batch size: " << ctx.batch_size << endl;
+
+    perf::time_instant_t start_time = perf::now ();
+
+    zmq::thread_t writer;
+    writer.start (writer_routine, &ctx, writer_affinity);
+
+    //  Read the messages. Once the pipe is dead, wait till the writer
+    //  revives it, the same way pipe_t reader does.
+    zmq::raw_message_t msg;
+    for (int msg_nbr = 0; msg_nbr != ctx.msg_count;) {
+        if (ctx.pipe.read (&msg))
+            msg_nbr ++;
+        else
+            ctx.revive.wait ();
+    }
+
+    perf::time_instant_t stop_time = perf::now ();
+    writer.stop ();
+
+    //  Throughput [msgs/s].
+    uint64_t msg_thput = ((uint64_t) 1000000000 *
+        (uint64_t) ctx.msg_count) / (uint64_t) (stop_time - start_time);
+
+    cout << "Your average throughput is " << msg_thput 
+        << " [msg/s]" << endl;
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <zmq.hpp>
+
+#include "../../transports/i_transport.hpp"
+#include "../scenarios/lb.hpp"
+
+using namespace std;
+
+//  Load balancing test runs within a single process, so that the exchange
+//  sees how many requests are queued for each worker. Requests are sent
+//  via process-wide exchange to the workers' queues, replies are sent to
+//  a single process-wide queue.
+
+class inproc_t : public perf::i_transport
+{
+public:
+
+    inproc_t (zmq::api_thread_t *api_, int exchange_id_) :
+        api (api_),
+        exchange_id (exchange_id_)
+    {
+    }
+
+    void send (size_t size_)
+    {
+        zmq::message_t message (size_);
+        api->send (exchange_id, message);
+    }
+
+    size_t receive ()
+    {
+        zmq::message_t message;
+        api->receive (&message);
+        return message.size ();
+    }
+
+private:
+
+    zmq::api_thread_t *api;
+    int exchange_id;
+};
+
+struct worker_args_t
+{
+    zmq::dispatcher_t *dispatcher;
+    zmq::locator_t *locator;
+    int worker_nbr;
+    int window;
+    uint64_t service_time;
+};
+
+static void worker_routine (void *arg_)
+{
+    worker_args_t *args = (worker_args_t*) arg_;
+    zmq::api_thread_t *api = zmq::api_thread_t::create (args->dispatcher,
+        args->locator);
+
+    //  The queue has to be limited, otherwise the exchange doesn't learn
+    //  how many requests are waiting in it.
+    char queue_name [16];
+    sprintf (queue_name, "Q_REQ_%d", args->worker_nbr);
+    api->create_queue (queue_name, zmq::scope_process, NULL, NULL, 0, NULL,
+        args->window, args->window - 1);
+    api->bind ("E_REQ", queue_name, NULL, NULL);
+
+    int exchange_id = api->create_exchange ("E_REP");
+    api->bind ("E_REP", "Q_REP", NULL, NULL);
+
+    inproc_t transport (api, exchange_id);
+    perf::remote_lb (&transport, args->service_time);
+}
+
+int main (int argc, char *argv [])
+{
+    if (argc < 6) {
+        cerr << "Usage: lb <style> <message size> <message count> <window> "
+            "<service time of worker 1 [us]> [<service time of worker 2 [us]> "
+            "...]" << endl;
+        return 1;
+    }
+
+    //  Parse & print command line arguments.
+    zmq::style_t style = (zmq::style_t) atoi (argv [1]);
+    size_t msg_size = atoi (argv [2]);
+    int msg_count = atoi (argv [3]);
+    int window = atoi (argv [4]);
+    int workers_count = argc - 5;
+
+    cout << "style: " << style << endl;
+    cout << "message size: " << msg_size << " [B]" << endl;
+    cout << "message count: " << msg_count << endl;
+    cout << "window: " << window << endl;
+    cout << "service times:";
+    for (int i = 0; i != workers_count; i++)
+        cout << " " << argv [5 + i];
+    cout << " [us]" << endl;
+
+    zmq::dispatcher_t dispatcher (workers_count + 1);
+    zmq::locator_t locator (NULL);
+    zmq::api_thread_t *api = zmq::api_thread_t::create (&dispatcher,
+        &locator);
+    int exchange_id = api->create_exchange ("E_REQ", zmq::scope_process,
+        NULL, NULL, 0, NULL, style);
+    api->create_queue ("Q_REP", zmq::scope_process);
+
+    //  Start the workers. They run until the process exits.
+    std::vector <worker_args_t> args (workers_count);
+    for (int i = 0; i != workers_count; i++) {
+        args [i].dispatcher = &dispatcher;
+        args [i].locator = &locator;
+        args [i].worker_nbr = i;
+        args [i].window = window;
+        args [i].service_time = atoi (argv [5 + i]);
+        zmq::thread_t *worker = new zmq::thread_t;
+        worker->start (worker_routine, &args [i]);
+    }
+
+    //  Do the job, for more detailed info refer to ../scenarios/lb.hpp.
+    inproc_t transport (api, exchange_id);
+    perf::local_lb (&transport, msg_size, msg_count, window, workers_count);
+
+    //  Workers never finish, don't wait for them.
+    exit (0);
+}
@@ -0,0 +1,155 @@
+/*
+    Copyright (c) 2007-2009 FastMQ Inc.
+
+    This file is part of 0MQ.
+
+    0MQ is free software; you can redistribute it and/or modify it under
+    the terms of the Lesser GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    0MQ is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    Lesser GNU General Public License for more details.
+
+    You should have received a copy of the Lesser GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+#include <zmq.hpp>
+
+#include "../../helpers/time.hpp"
+
+using namespace std;
+
+//  Measures how stale the quotes processed by a slow consumer are, with and
+//  without conflation in the queue. Publisher sends quotes for a number of
+//  instruments as fast as it can, consumer spends a fixed time processing
+//  each quote. Quotes are laid out the same way as in examples/exchange
+//  (message type, bid, ask) with instrument ID and timestamp added:
+//
+//  | type (1B) | instrument (2B) | bid (2B) | ask (2B) | timestamp (8B) |
+//
+//  Message type and instrument ID form the key of the quote. Publisher
+//  finishes by sending 1-byte message that is never conflated.
+
+enum
+{
+    msg_type_quote = 4,
+    quote_size = 15,
+    quote_key_size = 3
+};
+
+struct publisher_args_t
+{
+    zmq::dispatcher_t *dispatcher;
+    zmq::locator_t *locator;
+    int msg_count;
+    int instrument_count;
+};
+
+static void publisher_routine (void *arg_)
+{
+    publisher_args_t *args = (publisher_args_t*) arg_;
+    zmq::api_thread_t *api = zmq::api_thread_t::create (args->dispatcher,
+        args->locator);
+    int exchange_id = api->create_exchange ("E_QUOTES");
+    api->bind ("E_QUOTES", "Q_QUOTES", NULL, NULL);
+
+    for (int msg_nbr = 0; msg_nbr != args->msg_count; msg_nbr++) {
+        zmq::message_t msg (quote_size);
+        unsigned char *buff = (unsigned char*) msg.data ();
+        zmq::put_uint8 (buff, msg_type_quote);
+        zmq::put_uint16 (buff + 1, msg_nbr % args->instrument_count);
+        zmq::put_uint16 (buff + 3, msg_nbr % 1000);
+        zmq::put_uint16 (buff + 5, msg_nbr % 1000 + 1);
+        zmq::put_uint64 (buff + 7, perf::now ());
+        api->send (exchange_id, msg);
+    }
+
+    zmq::message_t end (1);
+    api->send (exchange_id, end);
+}
+
+int main (int argc, char *argv [])
+{
+    if (argc != 5) {
+        cerr << "Usage: quotes <message count> <instrument count> "
+            "<processing time [us]> <conflate (0|1)>" << endl;
+        return 1;
+    }
+
+    //  Parse & print command line arguments.
+    int msg_count = atoi (argv [1]);
+    int instrument_count = atoi (argv [2]);
+    uint64_t processing_time = atoi (argv [3]);
+    bool conflate = atoi (argv [4]) != 0;
+
+    cout << "message count: " << msg_count << endl;
+    cout << "instrument count: " << instrument_count << endl;
+    cout << "processing time: " << processing_time << " [us]" << endl;
+    cout << "conflate: " << conflate << endl;
+
+    zmq::dispatcher_t dispatcher (2);
+    zmq::locator_t locator (NULL);
+    zmq::api_thread_t *api = zmq::api_thread_t::create (&dispatcher,
+        &locator);
+    api->create_queue ("Q_QUOTES", zmq::scope_process, NULL, NULL, 0, NULL,
+        zmq::no_limit, zmq::no_limit, zmq::no_swap,
+        conflate ? (size_t) quote_key_size : (size_t) zmq::no_conflate);
+
+    publisher_args_t args;
+    args.dispatcher = &dispatcher;
+    args.locator = &locator;
+    args.msg_count = msg_count;
+    args.instrument_count = instrument_count;
+    zmq::thread_t publisher;
+    publisher.start (publisher_routine, &args);
+
+    //  Process the quotes, measuring their age at the time processing
+    //  starts.
+    std::vector <uint64_t> ages;
+    ages.reserve (msg_count);
+    perf::time_instant_t start_time = 0;
+    while (true) {
+        zmq::message_t msg;
+        api->receive (&msg);
+        if (msg.size () == 1)
+            break;
+        assert (msg.size () == quote_size);
+        perf::time_instant_t now = perf::now ();
+        if (ages.empty ())
+            start_time = now;
+        ages.push_back (now -
+            zmq::get_uint64 ((unsigned char*) msg.data () + 7));
+        if (processing_time) {
+            perf::time_instant_t deadline = now + processing_time * 1000;
+            while (perf::now () < deadline)
+                ;
+        }
+    }
+    perf::time_instant_t stop_time = perf::now ();
+    publisher.stop ();
+
+    //  Calculate & print results.
+    std::sort (ages.begin (), ages.end ());
+    uint64_t p50 = ages [ages.size () / 2] / 1000;
+    uint64_t p99 = ages [ages.size () * 99 / 100] / 1000;
+    uint64_t max = ages.back () / 1000;
+    uint64_t test_time = (stop_time - start_time) / 1000000;
+
+    cout << "Your processed quote count is " << ages.size () << endl;
+    cout << "Your median quote age is " << p50 << " [us]" << endl;
+    cout << "Your 99th percentile quote age is " << p99 << " [us]" << endl;
+    cout << "Your maximal quote age is " << max << " [us]" << endl;
+    cout << "Your processing time is " << test_time << " [ms]" << endl;
+
+    return 0;
+}
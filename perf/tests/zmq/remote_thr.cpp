@@ -28,9 +28,9 @@ using namespace std;
 
 int main (int argc, char *argv [])
 {
-    if (argc != 4) { 
+    if (argc != 4 && argc != 5) { 
         cerr << "Usage: remote_thr <hostname> <message size> "
-            << "<message count>" << endl; 
+            << "<message count> [<engine options>]" << endl; 
         return 1;
     }
 
@@ -38,20 +38,39 @@ int main (int argc, char *argv [])
     const char *host = argv [1];
     size_t msg_size = atoi (argv [2]);
     int msg_count = atoi (argv [3]);
+    const char *engine_options = argc == 5 ? argv [4] : NULL;
 
     cout << "message size: " << msg_size << " [B]" << endl;
     cout << "message count: " << msg_count << endl << endl;
 
-    //  Create zmq transport with bind = true. It means that created local 
-    //  exchange will be binded to the global queue QIN
-    //  and created local queue will be binded to global exchange EOUT. 
-    //  Global queue and exchange have to be created before
-    //  by the local_thr.
-    perf::zmq_t transport (host, true, "EOUT", "QIN", NULL, NULL);
+    {
+        //  Create zmq transport with bind = true. It means that created
+        //  local exchange will be binded to the global queue QIN
+        //  and created local queue will be binded to global exchange EOUT. 
+        //  Global queue and exchange have to be created before
+        //  by the local_thr.
+        perf::zmq_t transport (host, true, "EOUT", "QIN", NULL, NULL,
+            engine_options);
+
+        //  Do the job, for more detailed info refer to ../scenarios/thr.hpp.
+        perf::remote_thr (&transport, msg_size, msg_count);
+    }
+
+#if defined ZMQ_HAVE_COUNTERS
+    //  Transport waits for the messages to be sent before it's destroyed,
+    //  so the counters cover all the messages by now.
+    uint32_t waits = zmq::counter_get (zmq::counter_poller_waits);
+    uint32_t changes = zmq::counter_get (zmq::counter_poller_changes);
+    uint32_t reads = zmq::counter_get (zmq::counter_socket_reads);
+    uint32_t writes = zmq::counter_get (zmq::counter_socket_writes);
+    cout << "poller waits: " << waits << endl;
+    cout << "poller changes: " << changes << endl;
+    cout << "socket reads: " << reads << endl;
+    cout << "socket writes: " << writes << endl;
+    cout << "syscalls per message: "
+        << (double) (waits + changes + reads + writes) / msg_count << endl;
+#endif
 
-    //  Do the job, for more detailed info refer to ../scenarios/thr.hpp.
-    perf::remote_thr (&transport, msg_size, msg_count);
-   
     return 0;
 }
 
@@ -32,7 +32,8 @@ namespace perf
     public:
         zmq_t (const char *host_, bool bind_, const char *exchange_name_,
               const char *queue_name_, const char *exchange_interface_,
-              const char *queue_interface_) :
+              const char *queue_interface_,
+              const char *engine_options_ = NULL) :
             dispatcher (2),
             locator (host_)
         {
@@ -49,11 +50,13 @@ namespace perf
                 exchange_id = api->create_exchange ("E_LOCAL",
                     zmq::scope_local, NULL, NULL, 0, NULL,
                     zmq::style_load_balancing);
-                api->bind ("E_LOCAL", queue_name_, worker, worker);
+                api->bind ("E_LOCAL", queue_name_, worker, worker,
+                    NULL, engine_options_);
                 
                 //  Create & bind local queue.
                 api->create_queue ("Q_LOCAL");
-                api->bind (exchange_name_, "Q_LOCAL", worker, worker);
+                api->bind (exchange_name_, "Q_LOCAL", worker, worker,
+                    engine_options_, NULL);
 
             } else {
                 assert (exchange_interface_);